@@ -0,0 +1,327 @@
+/**
+ * @file   bench.cc
+ *
+ * @file   unit-fq-store.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Throughput benchmarks of parsing, inflating, ingestion and export, on
+ * synthetic reads. Prints one JSON object per benchmark and line.
+ */
+
+#include <clipp.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "fastq_generator.h"
+#include "read/reader.h"
+#include "utils/utils.h"
+#include "write/fqfile.h"
+#include "write/writer.h"
+
+using namespace tiledb::fq;
+
+namespace {
+
+/** Benchmark parameters. */
+struct BenchParams {
+  std::string dir = "tiledb_fq_bench_data";
+  /** Size of the FastQ text of each profile. */
+  uint64_t size_mb = 256;
+  unsigned num_threads = std::thread::hardware_concurrency();
+  unsigned memory_budget_mb = 1024;
+  /** Compression preset of the ingested arrays. */
+  std::string compression = "balanced";
+  /** Profiles and benchmarks to run; all if empty. */
+  std::vector<std::string> profiles;
+  std::vector<std::string> benchmarks;
+  bool keep = false;
+};
+
+/** Measurements of one benchmark. */
+struct Result {
+  std::string benchmark;
+  std::string profile;
+  uint64_t records = 0;
+  /** Size of the FastQ text processed. */
+  uint64_t bytes = 0;
+  double seconds = 0;
+  uint64_t peak_rss_kb = 0;
+};
+
+/**
+ * Resets the peak resident set size, so that each benchmark reports its own.
+ * Only supported on Linux; elsewhere the peak is that of the whole run.
+ */
+void reset_peak_rss() {
+  std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+/** Returns the peak resident set size since the last reset, in KB. */
+uint64_t peak_rss_kb() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (utils::starts_with(line, "VmHWM:"))
+      return std::stoull(line.substr(6));
+  }
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return uint64_t(usage.ru_maxrss) / 1024;
+#else
+  return uint64_t(usage.ru_maxrss);
+#endif
+}
+
+void print_result(const Result& r, const BenchParams& params) {
+  const double seconds = std::max(r.seconds, 1e-9);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3) << "{\"benchmark\": \""
+     << r.benchmark << "\", \"profile\": \"" << r.profile
+     << "\", \"threads\": " << params.num_threads
+     << ", \"compression\": \"" << params.compression << "\""
+     << ", \"records\": " << r.records << ", \"bytes\": " << r.bytes
+     << ", \"seconds\": " << r.seconds
+     << ", \"mb_per_s\": " << r.bytes / seconds / (1024 * 1024)
+     << ", \"reads_per_s\": " << r.records / seconds
+     << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+  std::cout << os.str() << std::endl;
+}
+
+/** Returns true if the name is selected by the list, or the list is empty. */
+bool selected(const std::vector<std::string>& list, const std::string& name) {
+  return list.empty() ||
+         std::find(list.begin(), list.end(), name) != list.end();
+}
+
+/** Parses the records of an uncompressed file, on one thread. */
+void bench_parse(const std::string& path) {
+  FQFile fq;
+  fq.open(path);
+  Buffer chunk;
+  std::vector<uint8_t> scores;
+  FQFile::FQRecordView rec;
+  while (fq.next_chunk(&chunk)) {
+    const char* p = chunk.data<char>();
+    const char* end = p + chunk.size();
+    while (p < end) {
+      p = FQFile::parse_record_view(p, end, &rec);
+      scores.resize(rec.quality.size);
+      FQFile::parse_quality_string(rec.quality, scores.data());
+    }
+  }
+}
+
+/**
+ * Inflates a gzip or BGZF file into chunks of whole records, without
+ * parsing.
+ */
+void bench_inflate(const std::string& path, const BenchParams& params) {
+  FQFile fq;
+  fq.set_memory_budget(params.memory_budget_mb);
+  fq.set_num_threads(params.num_threads);
+  fq.open(path);
+  Buffer chunk;
+  while (fq.next_chunk(&chunk))
+    ;
+}
+
+void bench_ingest(
+    const std::string& input_uri,
+    const std::string& array_uri,
+    const BenchParams& params) {
+  IngestionParams args;
+  args.uri = array_uri;
+  args.input_uri = input_uri;
+  args.num_threads = params.num_threads;
+  args.memory_budget_mb = params.memory_budget_mb;
+  args.compression = params.compression;
+  Writer writer;
+  writer.set_all_params(args);
+  writer.ingest();
+}
+
+void bench_export(
+    const std::string& array_uri,
+    const std::string& output_uri,
+    const BenchParams& params) {
+  ExportParams args;
+  args.uri = array_uri;
+  args.output_uri = output_uri;
+  args.num_threads = params.num_threads;
+  args.memory_budget_mb = params.memory_budget_mb;
+  Reader reader;
+  reader.set_all_params(args);
+  reader.export_fastq();
+}
+
+/** Runs the selected benchmarks on reads of the given profile. */
+void run_profile(const ReadProfile& profile, const BenchParams& params) {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+  const std::string base = params.dir + "/" + profile.name;
+  const std::string plain_path = base + ".fastq";
+  const std::string gzip_path = base + ".fastq.gz";
+  const std::string bgzf_path = base + ".bgzf.fastq.gz";
+  const std::string array_uri = base + ".tdb";
+  const std::string bgzf_array_uri = base + ".bgzf.tdb";
+  const std::string output_path = base + ".export.fastq";
+  const std::string gzip_output_path = base + ".export.fastq.gz";
+
+  std::cerr << "Generating " << params.size_mb << " MB of '" << profile.name
+            << "' reads" << std::endl;
+  const uint64_t min_bytes = params.size_mb * 1024 * 1024;
+  const uint64_t num_records = FastqGenerator(profile).write_file(
+      plain_path, min_bytes, FileCompression::None);
+  FastqGenerator(profile).write_file(
+      gzip_path, min_bytes, FileCompression::Gzip);
+  FastqGenerator(profile).write_file(
+      bgzf_path, min_bytes, FileCompression::Bgzf);
+  const uint64_t bytes = vfs.file_size(plain_path);
+  for (const auto& uri : {array_uri, bgzf_array_uri}) {
+    if (vfs.is_dir(uri))
+      vfs.remove_dir(uri);
+  }
+
+  auto run = [&](const std::string& name, const std::function<void()>& f) {
+    if (!selected(params.benchmarks, name))
+      return;
+    std::cerr << "Running " << name << " on '" << profile.name << "'"
+              << std::endl;
+    Result result;
+    result.benchmark = name;
+    result.profile = profile.name;
+    result.records = num_records;
+    result.bytes = bytes;
+    reset_peak_rss();
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    result.seconds = utils::chrono_duration(start);
+    result.peak_rss_kb = peak_rss_kb();
+    print_result(result, params);
+  };
+
+  run("parse", [&]() { bench_parse(plain_path); });
+  run("inflate", [&]() { bench_inflate(gzip_path, params); });
+  run("inflate-bgzf", [&]() { bench_inflate(bgzf_path, params); });
+  run("ingest", [&]() { bench_ingest(gzip_path, array_uri, params); });
+  run("ingest-bgzf",
+      [&]() { bench_ingest(bgzf_path, bgzf_array_uri, params); });
+  // Export reads the array of an ingest benchmark, to plain FastQ or BGZF.
+  const std::string export_uri =
+      vfs.is_dir(array_uri) ? array_uri : bgzf_array_uri;
+  if (vfs.is_dir(export_uri)) {
+    run("export", [&]() { bench_export(export_uri, output_path, params); });
+    run("export-bgzf",
+        [&]() { bench_export(export_uri, gzip_output_path, params); });
+  }
+
+  if (!params.keep) {
+    for (const auto& path :
+         {plain_path, gzip_path, bgzf_path, output_path, gzip_output_path}) {
+      if (vfs.is_file(path))
+        vfs.remove_file(path);
+    }
+    for (const auto& uri : {array_uri, bgzf_array_uri}) {
+      if (vfs.is_dir(uri))
+        vfs.remove_dir(uri);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  using namespace clipp;
+  BenchParams params;
+  bool help = false;
+  auto cli =
+      (option("-d", "--dir") %
+           "Directory for the generated data. [default "
+           "tiledb_fq_bench_data]" &
+           value("path", params.dir),
+       option("-s", "--size-mb") %
+               "Size of the FastQ text of each profile (MB). [default 256]" &
+           value("MB", params.size_mb),
+       option("-t", "--threads") % "Number of threads." &
+           value("N", params.num_threads),
+       option("-b", "--mem-budget-mb") % "The memory budget (MB)." &
+           value("MB", params.memory_budget_mb),
+       option("-c", "--compression") %
+               "Compression preset of the arrays: fast-ingest, balanced, "
+               "archive, bzip2. [default balanced]" &
+           value("preset", params.compression),
+       option("-p", "--profile") %
+               "Read profiles to benchmark: short-binned, "
+               "trimmed-decaying, long-uniform. [default all]" &
+           values("name", params.profiles),
+       option("-r", "--run") %
+               "Benchmarks to run: parse, inflate, inflate-bgzf, ingest, "
+               "ingest-bgzf, export, export-bgzf. [default all]" &
+           values("name", params.benchmarks),
+       option("-k", "--keep").set(params.keep) %
+           "Keep the generated data and arrays.",
+       option("-h", "--help").set(help) % "Print this help message.");
+
+  if (!parse(argc, argv, cli) || help) {
+    clipp::doc_formatting fmt{};
+    fmt.start_column(4).doc_column(25);
+    std::cout << "USAGE\n"
+              << usage_lines(cli, "tiledb_fq_bench", fmt) << "\n\nOPTIONS\n"
+              << documentation(cli, fmt) << "\n";
+    return help ? 0 : 1;
+  }
+
+  try {
+    tiledb::Context ctx;
+    tiledb::VFS vfs(ctx);
+    const bool create_dir = !vfs.is_dir(params.dir);
+    if (create_dir)
+      vfs.create_dir(params.dir);
+    for (const auto& profile : default_read_profiles()) {
+      if (selected(params.profiles, profile.name))
+        run_profile(profile, params);
+    }
+    if (create_dir && !params.keep)
+      vfs.remove_dir(params.dir);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
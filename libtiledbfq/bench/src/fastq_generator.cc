@@ -0,0 +1,195 @@
+/**
+ * @file   fastq_generator.cc
+ *
+ * @file   unit-fq-store.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Synthetic FastQ records for benchmarks.
+ */
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "fastq_generator.h"
+#include "utils/bgzf.h"
+
+namespace tiledb {
+namespace fq {
+
+std::vector<ReadProfile> default_read_profiles() {
+  return {
+      // Short reads of a recent Illumina run.
+      {"short-binned", 150, 150, 0.001, QualityModel::Binned},
+      // Older Illumina reads, trimmed to varying lengths.
+      {"trimmed-decaying", 50, 100, 0.01, QualityModel::Decaying},
+      // Long reads with noisy qualities and many ambiguous bases.
+      {"long-uniform", 1000, 20000, 0.05, QualityModel::Uniform},
+  };
+}
+
+FastqGenerator::FastqGenerator(const ReadProfile& profile, uint64_t seed)
+    : profile_(profile)
+    , rng_(seed)
+    , num_records_(0) {
+  if (profile_.min_length > profile_.max_length)
+    throw std::runtime_error(
+        "Error generating reads; profile '" + profile_.name +
+        "' has a minimum read length above its maximum.");
+}
+
+void FastqGenerator::append_record(std::string* text) {
+  std::uniform_int_distribution<uint32_t> length_dist(
+      profile_.min_length, profile_.max_length);
+  std::uniform_int_distribution<unsigned> coord_dist(1000, 30000);
+  std::uniform_int_distribution<unsigned> base_dist(0, 3);
+  std::bernoulli_distribution n_dist(profile_.n_rate);
+
+  const uint64_t i = num_records_++;
+  text->append(
+      "@BENCH:1:FC:1:" + std::to_string(1101 + i / 1000000) + ":" +
+      std::to_string(coord_dist(rng_)) + ":" +
+      std::to_string(coord_dist(rng_)) + " 1:N:0:1\n");
+
+  // Ambiguous bases get the lowest score, as basecallers report them.
+  const uint32_t length = length_dist(rng_);
+  std::string quality(length, '!');
+  for (uint32_t p = 0; p < length; p++) {
+    if (n_dist(rng_)) {
+      text->push_back('N');
+      quality[p] = char(33 + 2);
+    } else {
+      text->push_back("ACGT"[base_dist(rng_)]);
+      quality[p] = char(33 + quality_score(p, length));
+    }
+  }
+  text->append("\n+\n");
+  text->append(quality);
+  text->push_back('\n');
+}
+
+uint64_t FastqGenerator::write_file(
+    const std::string& path,
+    uint64_t min_bytes,
+    FileCompression compression) {
+  const bool gzip = compression == FileCompression::Gzip;
+  gzFile gz = nullptr;
+  std::ofstream os;
+  if (gzip)
+    gz = gzopen(path.c_str(), "wb");
+  else
+    os.open(path, std::ios::binary);
+  if (gzip ? gz == nullptr : !os)
+    throw std::runtime_error(
+        "Error generating reads; cannot open '" + path + "'");
+
+  // BGZF files are written a block at a time, with the utils/bgzf writer.
+  z_stream strm;
+  std::vector<uint8_t> block;
+  if (compression == FileCompression::Bgzf) {
+    std::memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(
+            &strm,
+            Z_DEFAULT_COMPRESSION,
+            Z_DEFLATED,
+            -15,
+            8,
+            Z_DEFAULT_STRATEGY) != Z_OK)
+      throw std::runtime_error(
+          "Error generating reads; zlib deflate initialization failed.");
+    block.resize(bgzf::MAX_BLOCK_SIZE);
+  }
+  auto write_bgzf = [&](const std::string& text) {
+    for (size_t i = 0; i < text.size(); i += bgzf::MAX_BLOCK_DATA_SIZE) {
+      const size_t block_size = bgzf::deflate_block(
+          &strm,
+          (const uint8_t*)text.data() + i,
+          std::min(text.size() - i, bgzf::MAX_BLOCK_DATA_SIZE),
+          block.data());
+      os.write((const char*)block.data(), block_size);
+    }
+    return bool(os);
+  };
+
+  // Records are generated and written a few MB at a time.
+  uint64_t size = 0, num_records = 0;
+  bool ok = true;
+  std::string text;
+  while (size < min_bytes && ok) {
+    append_record(&text);
+    num_records++;
+    if (text.size() < 4 * 1024 * 1024 && size + text.size() < min_bytes)
+      continue;
+    if (gzip)
+      ok = gzwrite(gz, text.data(), (unsigned)text.size()) ==
+           (int)text.size();
+    else if (compression == FileCompression::Bgzf)
+      ok = write_bgzf(text);
+    else
+      ok = bool(os.write(text.data(), text.size()));
+    size += text.size();
+    text.clear();
+  }
+  if (compression == FileCompression::Bgzf) {
+    deflateEnd(&strm);
+    os.write((const char*)bgzf::EOF_BLOCK, bgzf::EOF_BLOCK_SIZE);
+  }
+  if (gzip)
+    ok = gzclose(gz) == Z_OK && ok;
+  else
+    os.close();
+  if (!ok || (!gzip && !os))
+    throw std::runtime_error(
+        "Error generating reads; cannot write '" + path + "'");
+  return num_records;
+}
+
+unsigned FastqGenerator::quality_score(uint32_t position, uint32_t length) {
+  switch (profile_.quality) {
+    case QualityModel::Binned: {
+      std::uniform_int_distribution<unsigned> dist(0, 99);
+      const unsigned r = dist(rng_);
+      return r < 1 ? 2 : r < 5 ? 12 : r < 15 ? 23 : 37;
+    }
+    case QualityModel::Decaying: {
+      std::normal_distribution<double> dist(
+          36.0 - 12.0 * position / length, 3.0);
+      return (unsigned)std::min(std::max(dist(rng_), 2.0), 41.0);
+    }
+    case QualityModel::Uniform:
+    default: {
+      std::uniform_int_distribution<unsigned> dist(0, 41);
+      return dist(rng_);
+    }
+  }
+}
+
+}  // namespace fq
+}  // namespace tiledb
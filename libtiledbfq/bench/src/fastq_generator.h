@@ -0,0 +1,120 @@
+/**
+ * @file   fastq_generator.h
+ *
+ * @file   unit-fq-store.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Synthetic FastQ records for benchmarks.
+ */
+
+#ifndef TILEDB_FASTQ_FASTQ_GENERATOR_H
+#define TILEDB_FASTQ_FASTQ_GENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace tiledb {
+namespace fq {
+
+/** Distribution of the quality scores of generated reads. */
+enum class QualityModel {
+  /** Scores binned to the four levels of recent Illumina instruments. */
+  Binned,
+  /** Scores around 35 that fall towards the end of the read. */
+  Decaying,
+  /** Scores drawn uniformly from 0 to 41. */
+  Uniform
+};
+
+/** Compression of a generated FastQ file. */
+enum class FileCompression {
+  None,
+  /** A single gzip member, inflated by one thread. */
+  Gzip,
+  /** BGZF blocks, which are inflated in parallel. */
+  Bgzf
+};
+
+/** Shape of the reads of a synthetic data set. */
+struct ReadProfile {
+  std::string name;
+  /** Read lengths are drawn uniformly from [min_length, max_length]. */
+  uint32_t min_length;
+  uint32_t max_length;
+  /** Fraction of bases that are 'N'. */
+  double n_rate;
+  QualityModel quality;
+};
+
+/** The read profiles benchmarked by default. */
+std::vector<ReadProfile> default_read_profiles();
+
+/**
+ * Generates FastQ records with Illumina-style headers, from a fixed seed so
+ * that every run benchmarks the same data.
+ */
+class FastqGenerator {
+ public:
+  /** Constructor. */
+  explicit FastqGenerator(const ReadProfile& profile, uint64_t seed = 1);
+
+  /** Appends the next record to the given text. */
+  void append_record(std::string* text);
+
+  /**
+   * Writes a FastQ file of whole records, with at least the given size.
+   *
+   * @param path Local path of the file
+   * @param min_bytes Size of the FastQ text to write, before compression
+   * @param compression Compression of the file
+   * @return Number of records written
+   *
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  uint64_t write_file(
+      const std::string& path,
+      uint64_t min_bytes,
+      FileCompression compression);
+
+ private:
+  ReadProfile profile_;
+
+  std::mt19937_64 rng_;
+
+  uint64_t num_records_;
+
+  /** Returns the Phred score of the base at the given position. */
+  unsigned quality_score(uint32_t position, uint32_t length);
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_FASTQ_GENERATOR_H
@@ -110,10 +110,23 @@ void do_store(const IngestionParams& args) {
   writer.ingest();
 }
 
+/** Parses an inclusive record range 'START:END' into the export params. */
+void parse_range(const std::string& range, ExportParams* args) {
+  auto bounds = utils::split(range, ':');
+  if (bounds.size() != 2 || bounds[0].empty() || bounds[1].empty() ||
+      bounds[0].find_first_not_of("0123456789") != std::string::npos ||
+      bounds[1].find_first_not_of("0123456789") != std::string::npos)
+    throw std::runtime_error(
+        "Error parsing record range '" + range + "'; expected START:END.");
+  args->record_start = std::stoull(bounds[0]);
+  args->record_end = std::stoull(bounds[1]);
+}
+
 /** Export. */
 void do_export(const ExportParams& args) {
   Reader reader;
   reader.set_all_params(args);
+  reader.export_fastq();
 }
 
 }  // namespace
@@ -123,30 +136,127 @@ int main(int argc, char** argv) {
   Mode opmode = Mode::UNDEF;
 
   IngestionParams store_args;
+  std::vector<std::string> store_inputs;
   auto store_mode =
       (required("-u", "--uri") % "TileDB-FastQ array URI" &
            value("uri", store_args.uri),
-       required("-i", "--input") % "URI of FastQ file to ingest." &
-           value("uri", store_args.input_uri),
+       required("-i", "--input") %
+               "URIs of FastQ files to ingest. Each may be a file, a "
+               "directory of FastQ files, a glob pattern such as "
+               "'run/*_R1.fastq.gz', a FIFO, or '-' for stdin." &
+           values("uri", store_inputs),
+       option("-I", "--mate-input") %
+               "URI of the FastQ file(s) of the second mates (R2) of "
+               "paired-end reads, whose first mates are in --input. May be a "
+               "directory or glob pattern, paired with the inputs in sorted "
+               "order." &
+           value("uri", store_args.mate_input_uri),
        option("-v", "--verbose").set(store_args.verbose) %
-           "Enable verbose output",
+           "Enable verbose output, with progress lines and statistics.",
+       option("--stats-json") %
+               "Write the statistics of each stage to this file, as JSON." &
+           value("path", store_args.stats_uri),
        option("-b", "--mem-budget-mb") %
                defaulthelp(
                    "The memory budget (MB).", store_args.memory_budget_mb) &
-           value("MB", store_args.memory_budget_mb));
+           value("MB", store_args.memory_budget_mb),
+       option("-t", "--threads") %
+               defaulthelp(
+                   "Total number of threads for ingestion, shared by the "
+                   "file workers between BGZF decompression and parsing.",
+                   store_args.num_threads) &
+           value("N", store_args.num_threads),
+       option("--file-workers") %
+               "Number of input files ingested concurrently. Files are "
+               "stored in input order; with more than one worker, their "
+               "records are counted first, in an extra pass over the input. "
+               "[default one per thread]" &
+           value("N", store_args.num_file_workers),
+       option("--scan-read-length").set(store_args.scan_read_length) %
+           "Scan the input first, and store fixed-length reads if all reads "
+           "have the same length.",
+       option("--tile-extent") %
+               "Number of records per tile. [default sized from the first "
+               "reads to about --tile-size-mb, and at most 1/16 of the "
+               "memory budget; must be even for paired-end reads]" &
+           value("N", store_args.tile_extent),
+       option("--tile-size-mb") %
+               "Target size of the tiles chosen automatically, uncompressed. "
+               "[default 8]" &
+           value("MB", store_args.tile_size_mb),
+       option("--raw-sequences").set(store_args.pack_sequences, false) %
+           "Store one char per base instead of 2-bit packed bases.",
+       option("--raw-descriptions")
+               .set(store_args.encode_descriptions, false) %
+           "Store every description ('+' line) verbatim, instead of only "
+           "those that are neither empty nor the same as the header.",
+       option("-q", "--quality-mode") %
+               "Quality score storage: 'lossless', 'illumina8' (8-level "
+               "binning), or a bin table 'MIN:VALUE,...' mapping each range "
+               "of scores starting at MIN to VALUE. [default lossless]" &
+           value("mode", store_args.quality_mode),
+       option("--header-index").set(store_args.header_index) %
+           "Build an index of the read names, for exporting reads by name.",
+       option("--tokenize-headers").set(store_args.tokenize_headers) %
+           "Store the fields of the read headers in separate columns, "
+           "following a template inferred from the first reads of each "
+           "input file. Shrinks Illumina-style headers.",
+       option("-c", "--compression") %
+               "Compression preset: 'fast-ingest' (LZ4), 'balanced' (zstd), "
+               "'archive' (smallest, slowest to write) or 'bzip2'. [default "
+               "balanced]" &
+           value("preset", store_args.compression),
+       option("--filters") %
+               "Filter pipelines overriding the preset, as comma-separated "
+               "NAME=PIPELINE entries. NAME is an attribute (header, "
+               "sequence, description, quality) or 'offsets'; PIPELINE is "
+               "filters joined by '+', with optional levels for gzip, zstd, "
+               "lz4 and bzip2, e.g. "
+               "'quality=zstd:9,offsets=double_delta+lz4'. Filters: gzip, "
+               "zstd, lz4, rle, bzip2, double_delta, positive_delta, "
+               "bit_width_reduction, bitshuffle, byteshuffle, or 'none'." &
+           value("spec", store_args.filters),
+       option("-a", "--append").set(store_args.append) %
+           "Append the records to an existing array, keeping its storage "
+           "format.");
 
   ExportParams export_args;
+  std::string export_range;
   auto export_mode =
       (required("-u", "--uri") % "TileDB-FastQ array URI" &
            value("uri", export_args.uri),
-       option("-o", "--output-path") % "The URI of output file to create." &
+       option("-o", "--output-path") %
+               "The URI of output file to create, or '-' for stdout. "
+               "[default stdout]" &
            value("path", export_args.output_uri),
+       option("-O", "--mate-output-path") %
+               "For paired-end arrays, the URI of the output file for the "
+               "second mates, which are otherwise interleaved." &
+           value("path", export_args.mate_output_uri),
        option("-v", "--verbose").set(export_args.verbose) %
-           "Enable verbose output",
+           "Enable verbose output, with progress lines and statistics.",
+       option("--stats-json") %
+               "Write the statistics of each stage to this file, as JSON." &
+           value("path", export_args.stats_uri),
        option("-b", "--mem-budget-mb") %
                defaulthelp(
                    "The memory budget (MB).", export_args.memory_budget_mb) &
-           value("MB", export_args.memory_budget_mb));
+           value("MB", export_args.memory_budget_mb),
+       option("-t", "--threads") %
+               defaulthelp(
+                   "Number of formatting threads.", export_args.num_threads) &
+           value("N", export_args.num_threads),
+       option("-z", "--compress").set(export_args.compress) %
+           "Write BGZF-compressed output, readable by gzip and htslib. Implied "
+           "for each output file by its path ending in '.gz'.",
+       option("-r", "--range") %
+               "Export only records START to END, inclusive, counting from "
+               "0." &
+           value("START:END", export_range),
+       option("-n", "--names") %
+               "Export only the reads named in this file, one per line. "
+               "Requires an array ingested with --header-index." &
+           value("path", export_args.names_uri));
 
   auto cli =
       (command("--version", "-v", "version").set(opmode, Mode::Version) %
@@ -175,9 +285,14 @@ int main(int argc, char** argv) {
       std::cout << version_info() << "\n";
       break;
     case Mode::Store:
+      store_args.input_uri = store_inputs.front();
+      store_args.more_input_uris.assign(
+          store_inputs.begin() + 1, store_inputs.end());
       do_store(store_args);
       break;
     case Mode::Export:
+      if (!export_range.empty())
+        parse_range(export_range, &export_args);
       do_export(export_args);
       break;
     default:
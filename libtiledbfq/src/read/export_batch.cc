@@ -0,0 +1,374 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "read/export_batch.h"
+#include "utils/descriptions.h"
+#include "utils/sequence_codec.h"
+#include "write/record_batch.h"
+
+namespace tiledb {
+namespace fq {
+
+uint64_t ExportBatch::RecordSize::total() const {
+  uint64_t size = header + sequence + description + quality;
+  for (uint64_t field_size : header_fields)
+    size += field_size;
+  return size;
+}
+
+ExportBatch::ExportBatch(const StorageFormat& format)
+    : format_(format)
+    , start_(0)
+    , num_records_(0)
+    , capacity_(0)
+    , header_size_(0)
+    , header_field_sizes_(format.header_template.size(), 0)
+    , sequence_size_(0)
+    , description_size_(0)
+    , quality_size_(0) {
+  // Binned qualities are stored as bin indices.
+  const auto& bins = format_.quality_bin_table;
+  for (unsigned i = 0; i < 256; i++) {
+    unsigned score = std::min(i, 255u - '!');
+    if (!bins.empty())
+      score = i < bins.size() ? bins[i].value : 0;
+    quality_chars_[i] = char('!' + score);
+  }
+}
+
+void ExportBatch::reserve(uint64_t num_records, const RecordSize& record_size) {
+  // Leave some slack for records larger than the estimate.
+  auto reserve = [num_records](Buffer* buffer, uint64_t size, bool exact) {
+    uint64_t bytes = num_records * std::max<uint64_t>(size, 1);
+    if (!exact)
+      bytes += bytes / 4;
+    buffer->resize(std::max<uint64_t>(buffer->size(), bytes));
+  };
+  const bool fixed = format_.fixed_read_length > 0;
+  const bool packed = format_.sequence_encoding == SequenceEncoding::TwoBit;
+  reserve(&header_, record_size.header, false);
+  const auto& fields = format_.header_template;
+  header_fields_.resize(fields.size());
+  for (size_t f = 0; f < fields.size(); f++) {
+    if (fields[f].kind != header_tokens::FieldKind::Constant)
+      reserve(
+          &header_fields_[f],
+          record_size.header_fields.at(f),
+          fields[f].kind == header_tokens::FieldKind::Integer);
+  }
+  reserve(&sequence_, record_size.sequence, fixed && !packed);
+  const bool kinds =
+      format_.description_encoding == DescriptionEncoding::Kinds;
+  if (kinds)
+    reserve(&description_kinds_, 1, true);
+  else
+    reserve(&description_, record_size.description, false);
+  reserve(&quality_, record_size.quality, fixed);
+
+  capacity_ = std::max(capacity_, num_records);
+  for (Buffer* buffer : {&header_, &sequence_, &quality_})
+    buffer->resize_offsets(capacity_);
+  if (!kinds)
+    description_.resize_offsets(capacity_);
+  for (size_t f = 0; f < fields.size(); f++) {
+    if (fields[f].kind == header_tokens::FieldKind::String)
+      header_fields_[f].resize_offsets(capacity_);
+  }
+}
+
+void ExportBatch::grow() {
+  capacity_ = std::max<uint64_t>(2 * capacity_, 1);
+  for (Buffer* buffer : {&header_, &sequence_, &quality_}) {
+    buffer->resize(std::max<uint64_t>(2 * buffer->size(), 1));
+    buffer->resize_offsets(capacity_);
+  }
+  if (format_.description_encoding == DescriptionEncoding::Kinds) {
+    description_kinds_.resize(capacity_);
+  } else {
+    description_.resize(std::max<uint64_t>(2 * description_.size(), 1));
+    description_.resize_offsets(capacity_);
+  }
+  const auto& fields = format_.header_template;
+  for (size_t f = 0; f < fields.size(); f++) {
+    Buffer& buffer = header_fields_[f];
+    if (fields[f].kind == header_tokens::FieldKind::Integer) {
+      buffer.resize(capacity_ * sizeof(uint64_t));
+    } else if (fields[f].kind == header_tokens::FieldKind::String) {
+      buffer.resize(std::max<uint64_t>(2 * buffer.size(), 1));
+      buffer.resize_offsets(capacity_);
+    }
+  }
+}
+
+void ExportBatch::set_query_buffers(tiledb::Query* query) {
+  header_.set_query_buffer<char>("header", *query);
+  const auto& fields = format_.header_template;
+  for (size_t f = 0; f < fields.size(); f++) {
+    Buffer& buffer = header_fields_[f];
+    const std::string name = header_tokens::attribute_name(f);
+    if (fields[f].kind == header_tokens::FieldKind::Integer)
+      query->set_buffer(
+          name, buffer.data<uint64_t>(), buffer.nelts<uint64_t>());
+    else if (fields[f].kind == header_tokens::FieldKind::String)
+      buffer.set_query_buffer<char>(name, *query);
+  }
+  if (format_.description_encoding == DescriptionEncoding::Kinds)
+    query->set_buffer(
+        descriptions::KIND_ATTRIBUTE,
+        description_kinds_.data<uint8_t>(),
+        description_kinds_.size());
+  else
+    description_.set_query_buffer<char>("description", *query);
+
+  const bool fixed = format_.fixed_read_length > 0;
+  if (format_.sequence_encoding == SequenceEncoding::TwoBit)
+    sequence_.set_query_buffer<uint8_t>("sequence", *query);
+  else if (fixed)
+    query->set_buffer("sequence", sequence_.data<char>(), sequence_.size());
+  else
+    sequence_.set_query_buffer<char>("sequence", *query);
+
+  if (fixed)
+    query->set_buffer("quality", quality_.data<uint8_t>(), quality_.size());
+  else
+    quality_.set_query_buffer<uint8_t>("quality", *query);
+}
+
+uint64_t ExportBatch::set_results(const tiledb::Query& query, uint64_t start) {
+  auto results = query.result_buffer_elements();
+  start_ = start;
+  header_size_ = results["header"].second;
+  const auto& fields = format_.header_template;
+  for (size_t f = 0; f < fields.size(); f++) {
+    if (fields[f].kind == header_tokens::FieldKind::String)
+      header_field_sizes_[f] =
+          results[header_tokens::attribute_name(f)].second;
+  }
+  sequence_size_ = results["sequence"].second;
+  quality_size_ = results["quality"].second;
+  num_records_ = format_.fixed_read_length > 0 ?
+                     quality_size_ / format_.fixed_read_length :
+                     results["quality"].first;
+
+  explicit_descriptions_.clear();
+  if (format_.description_encoding == DescriptionEncoding::Kinds) {
+    // The explicit descriptions are read separately.
+    description_.clear();
+    description_size_ = 0;
+    const uint8_t* kinds = description_kinds_.data<uint8_t>();
+    for (uint64_t i = 0; i < num_records_; i++) {
+      if (kinds[i] == uint8_t(descriptions::Kind::Explicit))
+        explicit_descriptions_.push_back(i);
+    }
+  } else {
+    description_size_ = results["description"].second;
+  }
+  return num_records_;
+}
+
+const std::vector<uint64_t>& ExportBatch::explicit_descriptions() const {
+  return explicit_descriptions_;
+}
+
+void ExportBatch::read_descriptions(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    const std::vector<uint64_t>& records) {
+  descriptions::read(ctx, array, records, &description_);
+  description_size_ = description_.size();
+}
+
+uint64_t ExportBatch::num_records() const {
+  return num_records_;
+}
+
+uint64_t ExportBatch::start() const {
+  return start_;
+}
+
+uint64_t ExportBatch::alloced_size() const {
+  uint64_t size = 0;
+  for (const Buffer* b :
+       {&header_, &sequence_, &description_, &description_kinds_, &quality_})
+    size += b->alloced_size() + b->offsets().capacity() * sizeof(uint64_t);
+  for (const auto& b : header_fields_)
+    size += b.alloced_size() + b.offsets().capacity() * sizeof(uint64_t);
+  return size + explicit_descriptions_.capacity() * sizeof(uint64_t);
+}
+
+void ExportBatch::to_fastq(Buffer* output, int mate) const {
+  const bool encoded =
+      format_.description_encoding == DescriptionEncoding::Kinds;
+  if (encoded && description_.offsets().size() != explicit_descriptions_.size())
+    throw std::runtime_error(
+        "Error exporting records; explicit descriptions not read");
+
+  // Each record is its fields, four newlines and the '@' and '+' markers.
+  // Qualities bound the number of bases, which are at most one char each.
+  // Descriptions stored as kinds are at most as long as the header.
+  uint64_t max_header_size = header_size_;
+  const auto& fields = format_.header_template;
+  if (!fields.empty())
+    max_header_size += num_records_ * header_tokens::max_joined_size(fields);
+  for (uint64_t field_size : header_field_sizes_)
+    max_header_size += field_size;
+  const uint64_t max_size = max_header_size * (encoded ? 2 : 1) +
+                            description_size_ + 2 * quality_size_ +
+                            6 * num_records_;
+  output->resize(max_size);
+  std::vector<header_tokens::Token> tokens(fields.size());
+  char* out = output->data<char>();
+
+  const bool packed = format_.sequence_encoding == SequenceEncoding::TwoBit;
+  const uint32_t read_length = format_.fixed_read_length;
+  const uint8_t* qualities = quality_.data<uint8_t>();
+  const uint8_t* kinds = description_kinds_.data<uint8_t>();
+  size_t next_explicit = 0;
+  for (uint64_t i = 0; i < num_records_; i++) {
+    if (mate >= 0 && (start_ + i) % 2 != uint64_t(mate))
+      continue;
+
+    *out++ = '@';
+    const char* header = out;
+    out = write_header(i, &tokens, out);
+    const uint64_t header_size = out - header;
+    *out++ = '\n';
+
+    // Empty reads are stored with placeholder cells.
+    auto quality = read_length > 0 ?
+                       std::make_pair(i * read_length, (i + 1) * read_length) :
+                       cell_range(quality_, quality_size_, i);
+    uint64_t num_bases = quality.second - quality.first;
+    if (num_bases == 1 && qualities[quality.first] == EMPTY_READ_QUALITY)
+      num_bases = 0;
+
+    auto sequence = packed || read_length == 0 ?
+                        cell_range(sequence_, sequence_size_, i) :
+                        std::make_pair(i * read_length, (i + 1) * read_length);
+    if (packed) {
+      if (num_bases > 0)
+        sequence_codec::decode(
+            sequence_.data<uint8_t>() + sequence.first,
+            sequence.second - sequence.first,
+            num_bases,
+            out);
+    } else if (num_bases > 0) {
+      if (sequence.second - sequence.first != num_bases)
+        throw std::runtime_error(
+            "Error exporting record " + std::to_string(start_ + i) +
+            "; sequence and quality lengths differ");
+      std::memcpy(out, sequence_.data<char>() + sequence.first, num_bases);
+    }
+    out += num_bases;
+    *out++ = '\n';
+
+    *out++ = '+';
+    if (encoded) {
+      switch (descriptions::Kind(kinds[i])) {
+        case descriptions::Kind::Empty:
+          break;
+        case descriptions::Kind::SameAsHeader:
+          std::memcpy(out, header, header_size);
+          out += header_size;
+          break;
+        case descriptions::Kind::Explicit: {
+          // Records of the other mate are skipped, so find the description.
+          while (explicit_descriptions_[next_explicit] < i)
+            next_explicit++;
+          const auto& offsets = description_.offsets();
+          const uint64_t begin = offsets[next_explicit];
+          const uint64_t end = next_explicit + 1 < offsets.size() ?
+                                   offsets[next_explicit + 1] :
+                                   description_size_;
+          std::memcpy(out, description_.data<char>() + begin, end - begin);
+          out += end - begin;
+          break;
+        }
+        default:
+          throw std::runtime_error(
+              "Error exporting record " + std::to_string(start_ + i) +
+              "; invalid description kind");
+      }
+    } else {
+      auto description = cell_range(description_, description_size_, i);
+      const char* desc = description_.data<char>() + description.first;
+      uint64_t desc_size = description.second - description.first;
+      if (is_padding(desc, desc_size)) {
+        desc++;
+        desc_size--;
+      }
+      std::memcpy(out, desc, desc_size);
+      out += desc_size;
+    }
+    *out++ = '\n';
+
+    for (uint64_t j = 0; j < num_bases; j++)
+      out[j] = quality_chars_[qualities[quality.first + j]];
+    out += num_bases;
+    *out++ = '\n';
+  }
+
+  output->resize(out - output->data<char>());
+}
+
+char* ExportBatch::write_header(
+    uint64_t i, std::vector<header_tokens::Token>* tokens, char* out) const {
+  auto header = cell_range(header_, header_size_, i);
+  const char* data = header_.data<char>() + header.first;
+  const uint64_t size = header.second - header.first;
+  const auto& fields = format_.header_template;
+  if (fields.empty() || size != 1 || *data != header_tokens::MATCHED_HEADER) {
+    const uint64_t padding = is_padding(data, size) ? 1 : 0;
+    std::memcpy(out, data + padding, size - padding);
+    return out + size - padding;
+  }
+
+  for (size_t f = 0; f < fields.size(); f++) {
+    const Buffer& buffer = header_fields_[f];
+    header_tokens::Token& token = (*tokens)[f];
+    if (fields[f].kind == header_tokens::FieldKind::Integer) {
+      token.number = buffer.data<uint64_t>()[i];
+    } else if (fields[f].kind == header_tokens::FieldKind::String) {
+      auto cell = cell_range(buffer, header_field_sizes_[f], i);
+      token.data = buffer.data<char>() + cell.first;
+      token.size = cell.second - cell.first;
+    }
+  }
+  return header_tokens::join(fields, tokens->data(), out);
+}
+
+std::pair<uint64_t, uint64_t> ExportBatch::cell_range(
+    const Buffer& buffer, uint64_t data_size, uint64_t i) const {
+  const auto& offsets = buffer.offsets();
+  return {offsets[i], i + 1 < num_records_ ? offsets[i + 1] : data_size};
+}
+
+}  // namespace fq
+}  // namespace tiledb
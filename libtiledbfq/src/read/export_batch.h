@@ -0,0 +1,191 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_EXPORT_BATCH_H
+#define TILEDB_FASTQ_EXPORT_BATCH_H
+
+#include <tiledb/tiledb>
+#include <vector>
+
+#include "utils/buffer.h"
+#include "utils/header_tokens.h"
+#include "utils/storage_format.h"
+
+namespace tiledb {
+namespace fq {
+
+/**
+ * Attribute buffers for a batch of consecutive records read from the array
+ * with a single query submission, and their conversion to FastQ text.
+ */
+class ExportBatch {
+ public:
+  /** Estimated size in bytes of a record, per attribute. */
+  struct RecordSize {
+    uint64_t header = 0;
+    /** Per field of the header template. */
+    std::vector<uint64_t> header_fields;
+    uint64_t sequence = 0;
+    uint64_t description = 0;
+    uint64_t quality = 0;
+
+    /** Returns the estimated size in bytes of a whole record. */
+    uint64_t total() const;
+  };
+
+  /**
+   * Constructor.
+   *
+   * @param format How the records are stored in the array
+   */
+  explicit ExportBatch(const StorageFormat& format);
+
+  /** Unimplemented rule-of-5. */
+  ExportBatch(ExportBatch&&) = delete;
+  ExportBatch(const ExportBatch&) = delete;
+  ExportBatch& operator=(ExportBatch&&) = delete;
+  ExportBatch& operator=(const ExportBatch&) = delete;
+
+  /**
+   * Allocates the buffers to hold the given number of records of the given
+   * estimated size. Buffers never shrink.
+   */
+  void reserve(uint64_t num_records, const RecordSize& record_size);
+
+  /** Doubles the size of all buffers. */
+  void grow();
+
+  /** Sets the buffers, at their full allocated size, on a read query. */
+  void set_query_buffers(tiledb::Query* query);
+
+  /**
+   * Records the results of a submitted read query.
+   *
+   * @param start Number of the first record read
+   * @return Number of records read
+   */
+  uint64_t set_results(const tiledb::Query& query, uint64_t start);
+
+  /**
+   * Returns the indices in the batch of the records read with explicit
+   * descriptions, if the descriptions are stored as kinds. Their
+   * descriptions must be read with read_descriptions() before converting
+   * the batch.
+   */
+  const std::vector<uint64_t>& explicit_descriptions() const;
+
+  /**
+   * Reads the explicit descriptions of the records read.
+   *
+   * @param array Descriptions array open for reading
+   * @param records Numbers of the records with the explicit_descriptions()
+   */
+  void read_descriptions(
+      const tiledb::Context& ctx,
+      const tiledb::Array& array,
+      const std::vector<uint64_t>& records);
+
+  /** Returns the number of records read. */
+  uint64_t num_records() const;
+
+  /** Returns the number of the first record read. */
+  uint64_t start() const;
+
+  /** Returns the memory allocated by the buffers, in bytes. */
+  uint64_t alloced_size() const;
+
+  /**
+   * Converts the records read to FastQ text.
+   *
+   * @param output Set to the FastQ text
+   * @param mate If 0 or 1, only converts the first or second mates of a
+   *    paired-end array, going by the parity of the record numbers
+   *
+   * @throws std::runtime_error if a record cannot be decoded.
+   */
+  void to_fastq(Buffer* output, int mate = -1) const;
+
+ private:
+  StorageFormat format_;
+
+  /** Phred+33 character for each stored quality value. */
+  char quality_chars_[256];
+
+  uint64_t start_;
+
+  uint64_t num_records_;
+
+  /** Capacity of the offsets buffers, in cells. */
+  uint64_t capacity_;
+
+  Buffer header_;
+
+  /** Values of the fields of the header template, one buffer per field. */
+  std::vector<Buffer> header_fields_;
+
+  Buffer sequence_;
+
+  /**
+   * The descriptions if stored raw, otherwise the explicit descriptions
+   * read from the descriptions array.
+   */
+  Buffer description_;
+
+  /** Kind of each description, if the descriptions are stored as kinds. */
+  Buffer description_kinds_;
+
+  std::vector<uint64_t> explicit_descriptions_;
+
+  Buffer quality_;
+
+  /** Sizes of the data returned for each attribute, in bytes. */
+  uint64_t header_size_;
+  std::vector<uint64_t> header_field_sizes_;
+  uint64_t sequence_size_;
+  uint64_t description_size_;
+  uint64_t quality_size_;
+
+  /**
+   * Writes the header of a record, joined from its fields if it matched the
+   * header template.
+   *
+   * @param i Index of the record in the batch
+   * @param tokens Scratch space for the fields
+   * @param out Set to the header
+   * @return One past the end of the header
+   */
+  char* write_header(
+      uint64_t i, std::vector<header_tokens::Token>* tokens, char* out) const;
+
+  /** Returns the [start, end) byte range of a var-length cell. */
+  std::pair<uint64_t, uint64_t> cell_range(
+      const Buffer& buffer, uint64_t data_size, uint64_t i) const;
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_EXPORT_BATCH_H
@@ -24,13 +24,153 @@
  * THE SOFTWARE.
  */
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
 
 #include "read/reader.h"
+#include "utils/bgzf.h"
+#include "utils/bounded_queue.h"
+#include "utils/descriptions.h"
+#include "utils/header_index.h"
+#include "utils/header_tokens.h"
+#include "utils/utils.h"
 
 namespace tiledb {
 namespace fq {
 
+namespace {
+/** Compresses data into a series of BGZF blocks. */
+void compress_bgzf(z_stream* strm, const Buffer& data, Buffer* output) {
+  const uint64_t num_blocks =
+      utils::ceil(uint64_t(data.size()), uint64_t(bgzf::MAX_BLOCK_DATA_SIZE));
+  output->resize(num_blocks * bgzf::MAX_BLOCK_SIZE);
+  size_t size = 0;
+  for (size_t offset = 0; offset < data.size();
+       offset += bgzf::MAX_BLOCK_DATA_SIZE) {
+    size += bgzf::deflate_block(
+        strm,
+        data.data<uint8_t>() + offset,
+        std::min(bgzf::MAX_BLOCK_DATA_SIZE, data.size() - offset),
+        output->data<uint8_t>() + size);
+  }
+  output->resize(size);
+}
+
+/** Returns true if the output URI names stdout. */
+bool is_stdout(const std::string& uri) {
+  return uri.empty() || uri == "-";
+}
+
+/**
+ * Opens an output file, replacing any existing file.
+ *
+ * @return The buffer to write the output through: the file's, or that of
+ *    stdout for a URI naming it
+ */
+std::streambuf* open_output(
+    tiledb::VFS* vfs, const std::string& uri, tiledb::VFS::filebuf* filebuf) {
+  if (is_stdout(uri)) {
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    // Each batch is written with one call; a bigger pipe lets the consumer
+    // drain one batch while the next is written. The pipe keeps its size if
+    // the system limit is lower.
+    struct stat st;
+    if (fstat(STDOUT_FILENO, &st) == 0 && S_ISFIFO(st.st_mode))
+      fcntl(STDOUT_FILENO, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+    return std::cout.rdbuf();
+  }
+
+  if (vfs->is_file(uri))
+    vfs->remove_file(uri);
+  if (filebuf->open(uri, std::ios::out) == nullptr)
+    throw std::runtime_error(
+        "Error exporting; cannot open output '" + uri + "'");
+  return filebuf;
+}
+
+/** FastQ text of a batch for each output file: the first and second mates. */
+typedef std::array<Buffer, 2> OutputBuffers;
+
+/** Writes the FastQ text of a batch to the output files. */
+void write_outputs(
+    const OutputBuffers& output, std::ostream* os, std::ostream* mate_os) {
+  os->write(output[0].data<char>(), output[0].size());
+  if (mate_os != nullptr)
+    mate_os->write(output[1].data<char>(), output[1].size());
+  if (!*os || (mate_os != nullptr && !*mate_os))
+    throw std::runtime_error("Error exporting; failed to write output");
+}
+
+/** Whether each output file, the first and second mates, is BGZF. */
+typedef std::array<bool, 2> OutputCompression;
+
+/**
+ * Returns whether each output file is BGZF: if requested, or if its URI
+ * ends in ".gz".
+ */
+OutputCompression output_compression(const ExportParams& args) {
+  return {{args.compress || utils::ends_with(args.output_uri, ".gz"),
+           args.compress || utils::ends_with(args.mate_output_uri, ".gz")}};
+}
+
+/** Ends the BGZF output files with the EOF block. */
+void write_eof_blocks(
+    const OutputCompression& compress,
+    std::ostream* os,
+    std::ostream* mate_os) {
+  if (compress[0])
+    os->write((const char*)bgzf::EOF_BLOCK, bgzf::EOF_BLOCK_SIZE);
+  if (mate_os != nullptr && compress[1])
+    mate_os->write((const char*)bgzf::EOF_BLOCK, bgzf::EOF_BLOCK_SIZE);
+}
+
+/** Initializes a zlib stream for compressing BGZF blocks. */
+void init_deflate(z_stream* strm) {
+  std::memset(strm, 0, sizeof(*strm));
+  if (deflateInit2(
+          strm,
+          Z_DEFAULT_COMPRESSION,
+          Z_DEFLATED,
+          -15,
+          8,
+          Z_DEFAULT_STRATEGY) != Z_OK)
+    throw std::runtime_error(
+        "Error exporting; zlib deflate initialization failed.");
+}
+
+/**
+ * Submits a read query with the batch buffers, growing them until at least
+ * one record fits.
+ *
+ * @param start Number of the first record read by this submission
+ * @return Status of the query
+ */
+tiledb::Query::Status read_batch(
+    tiledb::Query* query, uint64_t start, ExportBatch* batch) {
+  for (;;) {
+    batch->set_query_buffers(query);
+    const auto status = query->submit();
+    if (status == tiledb::Query::Status::FAILED)
+      throw std::runtime_error("Error exporting; read query failed");
+    if (batch->set_results(*query, start) > 0 ||
+        status != tiledb::Query::Status::INCOMPLETE)
+      return status;
+    // Not even one record fit in the buffers.
+    batch->grow();
+  }
+}
+}  // namespace
+
 Reader::Reader() {
 }
 
@@ -38,5 +178,523 @@ void Reader::set_all_params(const ExportParams& args) {
   args_ = args;
 }
 
+const Stats& Reader::stats() const {
+  return stats_;
+}
+
+void Reader::init_tiledb() {
+  if (ctx_ == nullptr)
+    ctx_.reset(new tiledb::Context);
+}
+
+void Reader::export_fastq() {
+  if (args_.record_start > args_.record_end)
+    throw std::runtime_error(
+        "Error exporting; record range start " +
+        std::to_string(args_.record_start) + " is past its end " +
+        std::to_string(args_.record_end) + ".");
+
+  init_tiledb();
+  stats_.clear();
+
+  tiledb::Array array(*ctx_, args_.uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  auto non_empty = array.non_empty_domain<uint64_t>();
+  if (format.description_encoding == DescriptionEncoding::Kinds)
+    descriptions_array_.reset(new tiledb::Array(
+        *ctx_, descriptions::array_uri(args_.uri), TILEDB_READ));
+
+  // Split paired output always holds whole pairs, so that the two files stay
+  // in step.
+  const bool split_mates = !args_.mate_output_uri.empty();
+  if (split_mates && !format.paired)
+    throw std::runtime_error(
+        "Error exporting; array '" + args_.uri +
+        "' does not hold paired-end reads.");
+  const uint64_t record_start =
+      split_mates ? args_.record_start & ~uint64_t(1) : args_.record_start;
+  const uint64_t record_end =
+      split_mates ? args_.record_end | uint64_t(1) : args_.record_end;
+  const bool to_stdout = is_stdout(args_.output_uri) ||
+                         (split_mates && is_stdout(args_.mate_output_uri));
+  if (split_mates && is_stdout(args_.output_uri) &&
+      is_stdout(args_.mate_output_uri))
+    throw std::runtime_error(
+        "Error exporting; the two mates cannot both be written to stdout.");
+
+  // Look up the names before creating the output, so that a failed lookup
+  // leaves no output behind.
+  const bool by_name = !args_.names_uri.empty();
+  std::vector<uint64_t> records;
+  if (by_name) {
+    for (uint64_t r : lookup(read_names(args_.names_uri))) {
+      if (r < record_start || r > record_end)
+        continue;
+      if (split_mates) {
+        if (records.empty() || records.back() != (r | 1)) {
+          records.push_back(r & ~uint64_t(1));
+          records.push_back(r | 1);
+        }
+      } else {
+        records.push_back(r);
+      }
+    }
+  }
+
+  tiledb::VFS vfs(*ctx_);
+  tiledb::VFS::filebuf filebuf(vfs);
+  std::ostream os(open_output(&vfs, args_.output_uri, &filebuf));
+  std::unique_ptr<tiledb::VFS::filebuf> mate_filebuf;
+  std::unique_ptr<std::ostream> mate_os;
+  if (split_mates) {
+    mate_filebuf.reset(new tiledb::VFS::filebuf(vfs));
+    mate_os.reset(new std::ostream(
+        open_output(&vfs, args_.mate_output_uri, mate_filebuf.get())));
+  }
+
+  // Progress goes to stderr while stdout holds the records.
+  std::ostream& log = to_stdout ? std::cerr : std::cout;
+  if (args_.verbose)
+    stats_.start_progress(&log, "records_exported", "bytes_written");
+
+  uint64_t num_records = 0;
+  if (by_name) {
+    num_records =
+        export_selected(array, format, records, &os, mate_os.get());
+  } else if (!non_empty.empty()) {
+    const uint64_t start = std::max(record_start, non_empty[0].second.first);
+    const uint64_t end = std::min(record_end, non_empty[0].second.second);
+    if (start <= end)
+      num_records =
+          export_records(array, format, start, end, &os, mate_os.get());
+  }
+  if (split_mates && !is_stdout(args_.mate_output_uri))
+    mate_filebuf->close();
+  if (!is_stdout(args_.output_uri))
+    filebuf.close();
+  if (to_stdout && !std::cout.flush())
+    throw std::runtime_error("Error exporting; failed to write output");
+  array.close();
+  if (descriptions_array_ != nullptr) {
+    descriptions_array_->close();
+    descriptions_array_.reset();
+  }
+  stats_.stop_progress();
+
+  if (args_.verbose)
+    log << "Exported " << num_records << " records in " << std::fixed
+        << std::setprecision(3) << stats_.elapsed_sec() << " sec.\n"
+        << "Export statistics: " << stats_.to_json() << std::flush;
+  if (!args_.stats_uri.empty())
+    utils::write_file(vfs, args_.stats_uri, stats_.to_json());
+}
+
+uint64_t Reader::export_records(
+    const tiledb::Array& array,
+    const StorageFormat& format,
+    uint64_t start,
+    uint64_t end,
+    std::ostream* os,
+    std::ostream* mate_os) {
+  const unsigned num_formatters = std::max(args_.num_threads, 1u);
+  const unsigned num_batches = num_formatters + 2;
+  const unsigned num_outputs = num_formatters + 2;
+  const int num_files = mate_os == nullptr ? 1 : 2;
+
+  // When compressing, each formatter also holds the uncompressed text.
+  const OutputCompression compress = output_compression(args_);
+  const bool any_compress = compress[0] || (num_files > 1 && compress[1]);
+  const unsigned num_buffers =
+      num_batches + num_outputs + (any_compress ? num_formatters : 0);
+
+  // Every batch and output buffer gets an equal share of half of the budget.
+  // The other half is headroom for buffer growth and for TileDB's own copies
+  // of the tiles during reads.
+  const uint64_t budget_bytes =
+      uint64_t(std::max(args_.memory_budget_mb, 1u)) * 1024 * 1024;
+  const uint64_t batch_bytes = budget_bytes / (2 * num_buffers);
+
+  // Batches are whole tiles where possible, so that no tile is read by two
+  // queries.
+  const auto record_size = estimate_record_size(array, format, start, end);
+  const uint64_t record_bytes = record_size.total() + 4 * sizeof(uint64_t);
+  const uint64_t tile_extent = format.tile_extent;
+  uint64_t batch_records = std::max<uint64_t>(batch_bytes / record_bytes, 1);
+  if (batch_records >= tile_extent)
+    batch_records -= batch_records % tile_extent;
+
+  BoundedQueue<ExportBatch*> free_batches(num_batches);
+  BoundedQueue<std::pair<uint64_t, ExportBatch*>> full_batches(num_batches);
+  BoundedQueue<OutputBuffers*> free_outputs(num_outputs);
+  BoundedQueue<std::pair<uint64_t, OutputBuffers*>> full_outputs(num_outputs);
+
+  // Time waiting on a queue is time its producers are behind.
+  free_batches.set_pop_wait_timer(&stats_.timer("wait_free_batches"));
+  full_batches.set_pop_wait_timer(&stats_.timer("wait_full_batches"));
+  free_outputs.set_pop_wait_timer(&stats_.timer("wait_free_outputs"));
+  full_outputs.set_pop_wait_timer(&stats_.timer("wait_full_outputs"));
+  Stats::Counter& records_exported = stats_.counter("records_exported");
+  Stats::Counter& bytes_formatted = stats_.counter("bytes_formatted");
+  Stats::Counter& bytes_written = stats_.counter("bytes_written");
+  Stats::Counter& read_time = stats_.timer("tiledb_read");
+  Stats::Counter& format_time = stats_.timer("format");
+  Stats::Counter& compress_time = stats_.timer("compress");
+  Stats::Counter& write_time = stats_.timer("write");
+
+  std::vector<std::unique_ptr<ExportBatch>> batches;
+  for (unsigned i = 0; i < num_batches; i++) {
+    batches.emplace_back(new ExportBatch(format));
+    free_batches.push(batches.back().get());
+  }
+  std::vector<std::unique_ptr<OutputBuffers>> outputs;
+  for (unsigned i = 0; i < num_outputs; i++) {
+    outputs.emplace_back(new OutputBuffers);
+    free_outputs.push(outputs.back().get());
+  }
+
+  // The first error closes all queues, which stops every stage.
+  std::mutex error_mtx;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr e) {
+    {
+      std::unique_lock<std::mutex> lck(error_mtx);
+      if (!error)
+        error = e;
+    }
+    free_batches.close();
+    full_batches.close();
+    free_outputs.close();
+    full_outputs.close();
+  };
+
+  // Stage 1: read the records in batches, each filled by one submission.
+  uint64_t num_records = 0;
+  std::thread reader([&]() {
+    try {
+      uint64_t index = 0;
+      ExportBatch* batch = nullptr;
+      for (uint64_t range_start = start; range_start <= end;) {
+        const uint64_t range_end = std::min(
+            end, range_start - range_start % batch_records + batch_records - 1);
+        tiledb::Query query(*ctx_, array);
+        query.set_subarray(std::array<uint64_t, 2>{range_start, range_end});
+
+        // An incomplete query is resubmitted until all its records are read.
+        uint64_t next = range_start;
+        auto status = tiledb::Query::Status::INCOMPLETE;
+        while (status == tiledb::Query::Status::INCOMPLETE) {
+          if (!free_batches.pop(&batch))
+            return;
+          batch->reserve(range_end - next + 1, record_size);
+          {
+            ScopedTimer timer(&read_time);
+            status = read_batch(&query, next, batch);
+            read_descriptions(batch, nullptr);
+          }
+          next += batch->num_records();
+          num_records += batch->num_records();
+          if (!full_batches.push({index++, batch}))
+            return;
+        }
+        range_start = range_end + 1;
+        if (range_end == end)
+          break;
+      }
+      full_batches.close();
+    } catch (...) {
+      fail(std::current_exception());
+    }
+  });
+
+  // Stage 2: convert the batches to FastQ text, compressed into independent
+  // BGZF blocks if requested.
+  std::atomic<unsigned> formatters_running(num_formatters);
+  std::vector<std::thread> formatters;
+  for (unsigned i = 0; i < num_formatters; i++) {
+    formatters.emplace_back([&]() {
+      z_stream strm;
+      bool deflate_init = false;
+      try {
+        if (any_compress) {
+          init_deflate(&strm);
+          deflate_init = true;
+        }
+
+        Buffer text;
+        OutputBuffers* output;
+        std::pair<uint64_t, ExportBatch*> batch;
+        // Take an output buffer before a batch, so the formatter holding the
+        // next batch to be written is never waiting for an output buffer.
+        while (free_outputs.pop(&output) && full_batches.pop(&batch)) {
+          for (int mate = 0; mate < num_files; mate++) {
+            Buffer* out = &(*output)[mate];
+            {
+              ScopedTimer timer(&format_time);
+              batch.second->to_fastq(
+                  compress[mate] ? &text : out, mate_os == nullptr ? -1 : mate);
+            }
+            bytes_formatted += compress[mate] ? text.size() : out->size();
+            if (compress[mate]) {
+              ScopedTimer timer(&compress_time);
+              compress_bgzf(&strm, text, out);
+            }
+          }
+          records_exported += batch.second->num_records();
+          free_batches.push(batch.second);
+          if (!full_outputs.push({batch.first, output}))
+            break;
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+      if (deflate_init)
+        deflateEnd(&strm);
+      if (--formatters_running == 0)
+        full_outputs.close();
+    });
+  }
+
+  // Stage 3: write the FastQ text, in order.
+  try {
+    std::map<uint64_t, OutputBuffers*> pending;
+    uint64_t next_index = 0;
+    std::pair<uint64_t, OutputBuffers*> output;
+    while (full_outputs.pop(&output)) {
+      pending.insert(output);
+      for (auto it = pending.find(next_index); it != pending.end();
+           it = pending.find(next_index)) {
+        {
+          ScopedTimer timer(&write_time);
+          write_outputs(*it->second, os, mate_os);
+        }
+        for (int mate = 0; mate < num_files; mate++)
+          bytes_written += (*it->second)[mate].size();
+        free_outputs.push(it->second);
+        pending.erase(it);
+        next_index++;
+      }
+    }
+    if (!error)
+      write_eof_blocks(compress, os, mate_os);
+  } catch (...) {
+    fail(std::current_exception());
+  }
+
+  reader.join();
+  for (auto& t : formatters)
+    t.join();
+  if (error)
+    std::rethrow_exception(error);
+
+  // Buffers never shrink, so their final size is their peak.
+  uint64_t buffer_bytes = 0;
+  for (const auto& batch : batches)
+    buffer_bytes += batch->alloced_size();
+  for (const auto& output : outputs) {
+    for (const auto& buffer : *output)
+      buffer_bytes += buffer.alloced_size();
+  }
+  Stats::update_peak(&stats_.peak("pipeline_buffer_bytes"), buffer_bytes);
+
+  return num_records;
+}
+
+uint64_t Reader::export_selected(
+    const tiledb::Array& array,
+    const StorageFormat& format,
+    const std::vector<uint64_t>& records,
+    std::ostream* os,
+    std::ostream* mate_os) {
+  const int num_files = mate_os == nullptr ? 1 : 2;
+  const OutputCompression compress = output_compression(args_);
+  const bool any_compress = compress[0] || (num_files > 1 && compress[1]);
+  if (records.empty()) {
+    write_eof_blocks(compress, os, mate_os);
+    return 0;
+  }
+
+  // The batch, its text and the compressed text share half of the budget.
+  const uint64_t budget_bytes =
+      uint64_t(std::max(args_.memory_budget_mb, 1u)) * 1024 * 1024;
+  const auto record_size =
+      estimate_record_size(array, format, records.front(), records.back());
+  const uint64_t record_bytes = record_size.total() + 4 * sizeof(uint64_t);
+  const uint64_t batch_records =
+      std::max<uint64_t>(budget_bytes / (6 * record_bytes), 1);
+
+  Stats::Counter& records_exported = stats_.counter("records_exported");
+  Stats::Counter& bytes_formatted = stats_.counter("bytes_formatted");
+  Stats::Counter& bytes_written = stats_.counter("bytes_written");
+  Stats::Counter& read_time = stats_.timer("tiledb_read");
+  Stats::Counter& format_time = stats_.timer("format");
+  Stats::Counter& compress_time = stats_.timer("compress");
+  Stats::Counter& write_time = stats_.timer("write");
+
+  z_stream strm;
+  if (any_compress)
+    init_deflate(&strm);
+  try {
+    ExportBatch batch(format);
+    Buffer text;
+    OutputBuffers output;
+    // Batches are numbered by their position in the export. Split paired
+    // output exports whole pairs, so the parity of a position is the mate.
+    uint64_t position = 0;
+    for (size_t first = 0; first < records.size(); first += batch_records) {
+      const size_t last =
+          std::min<size_t>(records.size(), first + batch_records);
+      // Runs of consecutive records are read as one range, and TileDB reads
+      // each tile once for all the ranges it covers.
+      tiledb::Query query(*ctx_, array);
+      for (size_t i = first; i < last;) {
+        size_t j = i + 1;
+        while (j < last && records[j] == records[j - 1] + 1)
+          j++;
+        query.add_range(0, records[i], records[j - 1]);
+        i = j;
+      }
+
+      batch.reserve(last - first, record_size);
+      auto status = tiledb::Query::Status::INCOMPLETE;
+      while (status == tiledb::Query::Status::INCOMPLETE) {
+        {
+          ScopedTimer timer(&read_time);
+          status = read_batch(&query, position, &batch);
+          read_descriptions(&batch, records.data() + position);
+        }
+        position += batch.num_records();
+        for (int mate = 0; mate < num_files; mate++) {
+          Buffer* out = &output[mate];
+          {
+            ScopedTimer timer(&format_time);
+            batch.to_fastq(
+                compress[mate] ? &text : out, mate_os == nullptr ? -1 : mate);
+          }
+          bytes_formatted += compress[mate] ? text.size() : out->size();
+          if (compress[mate]) {
+            ScopedTimer timer(&compress_time);
+            compress_bgzf(&strm, text, out);
+          }
+          bytes_written += out->size();
+        }
+        {
+          ScopedTimer timer(&write_time);
+          write_outputs(output, os, mate_os);
+        }
+        records_exported += batch.num_records();
+      }
+    }
+    write_eof_blocks(compress, os, mate_os);
+  } catch (...) {
+    if (any_compress)
+      deflateEnd(&strm);
+    throw;
+  }
+  if (any_compress)
+    deflateEnd(&strm);
+
+  return records.size();
+}
+
+std::vector<uint64_t> Reader::lookup(const std::vector<std::string>& names) {
+  init_tiledb();
+  tiledb::Array array(*ctx_, args_.uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  array.close();
+  if (!format.header_index)
+    throw std::runtime_error(
+        "Error looking up reads; array '" + args_.uri +
+        "' has no header index.");
+
+  std::vector<header_index::NameHash> hashes;
+  hashes.reserve(names.size());
+  for (const auto& name : names) {
+    const char* data = name.data();
+    size_t size = name.size();
+    if (size > 0 && data[0] == '@') {
+      data++;
+      size--;
+    }
+    size = header_index::name_length(data, size);
+    hashes.push_back(header_index::hash_name(data, size));
+  }
+
+  tiledb::Array index(
+      *ctx_, header_index::index_uri(args_.uri), TILEDB_READ);
+  auto records = header_index::find(*ctx_, index, hashes);
+  index.close();
+  return records;
+}
+
+std::vector<std::string> Reader::read_names(const std::string& uri) const {
+  tiledb::VFS vfs(*ctx_);
+  tiledb::VFS::filebuf filebuf(vfs);
+  if (filebuf.open(uri, std::ios::in) == nullptr)
+    throw std::runtime_error(
+        "Error exporting; cannot open names file '" + uri + "'");
+  std::istream is(&filebuf);
+  std::vector<std::string> names;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (!line.empty())
+      names.push_back(line);
+  }
+  filebuf.close();
+  return names;
+}
+
+void Reader::read_descriptions(ExportBatch* batch, const uint64_t* records) {
+  const auto& indices = batch->explicit_descriptions();
+  if (indices.empty())
+    return;
+  std::vector<uint64_t> numbers(indices.size());
+  for (size_t i = 0; i < indices.size(); i++)
+    numbers[i] =
+        records == nullptr ? batch->start() + indices[i] : records[indices[i]];
+  batch->read_descriptions(*ctx_, *descriptions_array_, numbers);
+}
+
+ExportBatch::RecordSize Reader::estimate_record_size(
+    const tiledb::Array& array,
+    const StorageFormat& format,
+    uint64_t start,
+    uint64_t end) const {
+  tiledb::Query query(*ctx_, array);
+  query.set_subarray(std::array<uint64_t, 2>{start, end});
+  const uint64_t num_records = end - start + 1;
+  auto var_size = [&](const std::string& attr) {
+    return utils::ceil(query.est_result_size_var(attr).second, num_records);
+  };
+
+  ExportBatch::RecordSize size;
+  size.header = var_size("header");
+  const auto& fields = format.header_template;
+  size.header_fields.assign(fields.size(), 0);
+  for (size_t f = 0; f < fields.size(); f++) {
+    if (fields[f].kind == header_tokens::FieldKind::Integer)
+      size.header_fields[f] = sizeof(uint64_t);
+    else if (fields[f].kind == header_tokens::FieldKind::String)
+      size.header_fields[f] = var_size(header_tokens::attribute_name(f));
+  }
+  // Explicit descriptions are rare, and the others are stored as one byte.
+  size.description = format.description_encoding == DescriptionEncoding::Raw ?
+                         var_size("description") :
+                         1;
+  if (format.fixed_read_length > 0) {
+    size.quality = format.fixed_read_length;
+    size.sequence = format.sequence_encoding == SequenceEncoding::Raw ?
+                        format.fixed_read_length :
+                        var_size("sequence");
+  } else {
+    size.quality = var_size("quality");
+    size.sequence = var_size("sequence");
+  }
+  return size;
+}
+
 }  // namespace fq
 }  // namespace tiledb
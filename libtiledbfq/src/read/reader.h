@@ -28,6 +28,7 @@
 #define TILEDB_FASTQ_READER_H
 
 #include <future>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -36,6 +37,10 @@
 
 #include <tiledb/tiledb>
 
+#include "read/export_batch.h"
+#include "utils/stats.h"
+#include "utils/storage_format.h"
+
 namespace tiledb {
 namespace fq {
 
@@ -46,9 +51,35 @@ namespace fq {
 /** Arguments/params for export. */
 struct ExportParams {
   std::string uri;
+  /** File to write the FastQ records to; empty or "-" for stdout. */
   std::string output_uri;
   unsigned memory_budget_mb = 2 * 1024;
+  /** Print progress lines and the statistics of the export. */
   bool verbose = false;
+  /** File to write the statistics of the export to, as JSON, if set. */
+  std::string stats_uri;
+  unsigned num_threads = std::thread::hardware_concurrency();
+  /**
+   * Write BGZF output. Implied, for each output file, by its URI ending in
+   * ".gz".
+   */
+  bool compress = false;
+  /** First record to export, counting from 0. */
+  uint64_t record_start = 0;
+  /** Last record to export, inclusive. Clamped to the last record stored. */
+  uint64_t record_end = std::numeric_limits<uint64_t>::max();
+  /**
+   * File listing the names of the reads to export, one per line. Requires a
+   * header index. The records in range with any of the names are exported,
+   * in record order.
+   */
+  std::string names_uri;
+  /**
+   * For paired-end arrays, file to write the second mates to, with the first
+   * mates written to output_uri; "-" for stdout. If empty, the mates are
+   * interleaved in output_uri.
+   */
+  std::string mate_output_uri;
 };
 
 /* ********************************* */
@@ -66,11 +97,106 @@ class Reader {
   Reader& operator=(Reader&&) = delete;
   Reader& operator=(const Reader&) = delete;
 
+  /**
+   * Exports the records of the array in the range given by the params to a
+   * FastQ file. Only the tiles covering the range are read.
+   *
+   * @throws std::runtime_error if the range start is past its end.
+   */
+  void export_fastq();
+
+  /**
+   * Finds the records with the given read names, using the header index. A
+   * name is matched against the header up to its first space or tab, and may
+   * start with '@'.
+   *
+   * Names are compared by a 96-bit hash, so a false match is possible but
+   * vanishingly unlikely.
+   *
+   * @param names Read names to find
+   * @return Sorted numbers of the records with any of the names
+   *
+   * @throws std::runtime_error if the array has no header index.
+   */
+  std::vector<uint64_t> lookup(const std::vector<std::string>& names);
+
   /** Sets all parameters. */
   void set_all_params(const ExportParams& args);
 
+  /**
+   * Returns the statistics of the last export: records and bytes written,
+   * time spent in each stage and waiting between stages, and peak buffer
+   * memory.
+   */
+  const Stats& stats() const;
+
  private:
   ExportParams args_;
+
+  std::unique_ptr<tiledb::Context> ctx_;
+
+  /**
+   * The descriptions array open for reading, if the descriptions are stored
+   * as kinds.
+   */
+  std::unique_ptr<tiledb::Array> descriptions_array_;
+
+  Stats stats_;
+
+  void init_tiledb();
+
+  /**
+   * Exports the records in the given inclusive range. Reading, conversion
+   * to FastQ text and writing run concurrently as stages of a pipeline.
+   *
+   * @param os Output stream
+   * @param mate_os If not null, stream for the second mates of a paired-end
+   *    array, whose first mates go to os
+   * @return Number of records exported
+   */
+  uint64_t export_records(
+      const tiledb::Array& array,
+      const StorageFormat& format,
+      uint64_t start,
+      uint64_t end,
+      std::ostream* os,
+      std::ostream* mate_os);
+
+  /**
+   * Exports the given records, in order. Used for scattered records, which
+   * are read with multi-range queries by a single thread.
+   *
+   * @param records Sorted numbers of the records to export, whole pairs if
+   *    mate_os is not null
+   * @param os Output stream
+   * @param mate_os If not null, stream for the second mates of a paired-end
+   *    array, whose first mates go to os
+   * @return Number of records exported
+   */
+  uint64_t export_selected(
+      const tiledb::Array& array,
+      const StorageFormat& format,
+      const std::vector<uint64_t>& records,
+      std::ostream* os,
+      std::ostream* mate_os);
+
+  /**
+   * Reads the explicit descriptions of a batch read, if it has any.
+   *
+   * @param records Numbers of the records of the batch, or null if the batch
+   *    holds consecutive records from its start
+   */
+  void read_descriptions(ExportBatch* batch, const uint64_t* records);
+
+  /** Reads a file of read names, one per line, skipping empty lines. */
+  std::vector<std::string> read_names(const std::string& uri) const;
+
+  /** Estimates the average size of the records in the given range. */
+  ExportBatch::RecordSize estimate_record_size(
+      const tiledb::Array& array,
+      const StorageFormat& format,
+      uint64_t start,
+      uint64_t end) const;
 };
 
 }  // namespace fq
@@ -0,0 +1,160 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "utils/bgzf.h"
+
+namespace tiledb {
+namespace fq {
+namespace bgzf {
+
+namespace {
+/** Size of the fixed part of a gzip member header. */
+const size_t GZIP_HEADER_SIZE = 12;
+
+/** Size of the gzip member trailer (CRC32 and ISIZE). */
+const size_t GZIP_FOOTER_SIZE = 8;
+
+/** Size of the header of the blocks written, with only the 'BC' subfield. */
+const size_t BLOCK_HEADER_SIZE = 18;
+
+uint16_t read_le16(const uint8_t* p) {
+  return uint16_t(p[0] | (p[1] << 8));
+}
+
+void write_le16(uint16_t v, uint8_t* p) {
+  p[0] = uint8_t(v);
+  p[1] = uint8_t(v >> 8);
+}
+
+void write_le32(uint32_t v, uint8_t* p) {
+  for (unsigned i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+uint32_t read_le32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+         (uint32_t(p[3]) << 24);
+}
+}  // namespace
+
+const uint8_t EOF_BLOCK[EOF_BLOCK_SIZE] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255,
+                                           6,  0,   66, 67, 2, 0, 27, 0, 3, 0,
+                                           0,  0,   0,  0,  0, 0, 0,  0};
+
+bool read_block(
+    const uint8_t* data, size_t size, size_t* block_size, size_t* data_size) {
+  // Magic, deflate compression method, and the FEXTRA flag.
+  if (size < GZIP_HEADER_SIZE || data[0] != 31 || data[1] != 139 ||
+      data[2] != 8 || (data[3] & 4) == 0)
+    return false;
+
+  // Look for the 'BC' subfield in the extra field.
+  const size_t xlen = read_le16(data + 10);
+  if (size < GZIP_HEADER_SIZE + xlen)
+    return false;
+  const uint8_t* extra = data + GZIP_HEADER_SIZE;
+  size_t bsize = 0;
+  for (size_t i = 0; i + 4 <= xlen;) {
+    const size_t slen = read_le16(extra + i + 2);
+    if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 &&
+        i + 6 <= xlen) {
+      bsize = size_t(read_le16(extra + i + 4)) + 1;
+      break;
+    }
+    i += 4 + slen;
+  }
+
+  if (bsize < GZIP_HEADER_SIZE + xlen + GZIP_FOOTER_SIZE || bsize > size)
+    return false;
+
+  *block_size = bsize;
+  *data_size = read_le32(data + bsize - 4);
+  return *data_size <= MAX_BLOCK_SIZE;
+}
+
+void inflate_block(
+    z_stream* strm,
+    const uint8_t* block,
+    size_t block_size,
+    uint8_t* dest,
+    size_t data_size) {
+  const size_t header_size = GZIP_HEADER_SIZE + read_le16(block + 10);
+  if (inflateReset(strm) != Z_OK)
+    throw std::runtime_error("Error decompressing; zlib stream reset failed.");
+
+  strm->next_in = const_cast<uint8_t*>(block + header_size);
+  strm->avail_in = (uInt)(block_size - header_size - GZIP_FOOTER_SIZE);
+  strm->next_out = dest;
+  strm->avail_out = (uInt)data_size;
+  int ret = inflate(strm, Z_FINISH);
+  if (ret != Z_STREAM_END || strm->avail_out != 0)
+    throw std::runtime_error(
+        "Error decompressing BGZF block; zlib inflate failed: " +
+        std::string(strm->msg != nullptr ? strm->msg : "size mismatch"));
+
+  const uint32_t crc = read_le32(block + block_size - GZIP_FOOTER_SIZE);
+  if (crc32(crc32(0L, Z_NULL, 0), dest, (uInt)data_size) != crc)
+    throw std::runtime_error("Error decompressing BGZF block; CRC mismatch.");
+}
+
+size_t deflate_block(
+    z_stream* strm, const uint8_t* data, size_t data_size, uint8_t* dest) {
+  if (data_size > MAX_BLOCK_DATA_SIZE)
+    throw std::runtime_error(
+        "Error compressing BGZF block; too much data for one block.");
+  if (deflateReset(strm) != Z_OK)
+    throw std::runtime_error("Error compressing; zlib stream reset failed.");
+
+  strm->next_in = const_cast<uint8_t*>(data);
+  strm->avail_in = (uInt)data_size;
+  strm->next_out = dest + BLOCK_HEADER_SIZE;
+  strm->avail_out =
+      (uInt)(MAX_BLOCK_SIZE - BLOCK_HEADER_SIZE - GZIP_FOOTER_SIZE);
+  if (deflate(strm, Z_FINISH) != Z_STREAM_END)
+    throw std::runtime_error(
+        "Error compressing BGZF block; zlib deflate failed.");
+  const size_t block_size = MAX_BLOCK_SIZE - strm->avail_out;
+
+  // gzip header with the FEXTRA flag, and the 'BC' subfield giving the block
+  // size minus one.
+  const uint8_t header[BLOCK_HEADER_SIZE - 2] = {
+      31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0};
+  std::memcpy(dest, header, sizeof(header));
+  write_le16(uint16_t(block_size - 1), dest + BLOCK_HEADER_SIZE - 2);
+
+  uint8_t* footer = dest + block_size - GZIP_FOOTER_SIZE;
+  write_le32(crc32(crc32(0L, Z_NULL, 0), data, (uInt)data_size), footer);
+  write_le32(uint32_t(data_size), footer + 4);
+  return block_size;
+}
+
+}  // namespace bgzf
+}  // namespace fq
+}  // namespace tiledb
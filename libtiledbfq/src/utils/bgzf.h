@@ -0,0 +1,108 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_BGZF_H
+#define TILEDB_FASTQ_BGZF_H
+
+#include <zlib.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace tiledb {
+namespace fq {
+namespace bgzf {
+
+/**
+ * BGZF ("blocked gzip") files are a series of gzip members, each holding at
+ * most 64KB of data and recording its own compressed size in a 'BC' extra
+ * header subfield. The block boundaries can therefore be found without
+ * decompressing, and the blocks inflated independently.
+ */
+
+/** Maximum size of a BGZF block, compressed or uncompressed. */
+const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+/**
+ * Maximum uncompressed size of a block written by deflate_block(), leaving
+ * room for the block to grow when the data does not compress.
+ */
+const size_t MAX_BLOCK_DATA_SIZE = 0xff00;
+
+/** Size of the empty block marking the end of a BGZF file. */
+const size_t EOF_BLOCK_SIZE = 28;
+
+/** The empty block marking the end of a BGZF file. */
+extern const uint8_t EOF_BLOCK[EOF_BLOCK_SIZE];
+
+/**
+ * Parses the header of the BGZF block starting at the given position.
+ *
+ * @param data Start of the block
+ * @param size Number of bytes available at data
+ * @param block_size Set to the total size of the block, in bytes
+ * @param data_size Set to the uncompressed size of the block, in bytes
+ * @return False if the bytes available do not hold a whole BGZF block
+ */
+bool read_block(
+    const uint8_t* data, size_t size, size_t* block_size, size_t* data_size);
+
+/**
+ * Inflates a whole BGZF block, and checks the CRC of the inflated data.
+ *
+ * @param strm zlib stream initialized for raw inflate (negative window bits)
+ * @param block Start of the block
+ * @param block_size Total size of the block, as given by read_block()
+ * @param dest Destination for the inflated data
+ * @param data_size Uncompressed size of the block, as given by read_block()
+ *
+ * @throws std::runtime_error if the block is corrupt.
+ */
+void inflate_block(
+    z_stream* strm,
+    const uint8_t* block,
+    size_t block_size,
+    uint8_t* dest,
+    size_t data_size);
+
+/**
+ * Compresses data into a single BGZF block.
+ *
+ * @param strm zlib stream initialized for raw deflate (negative window bits)
+ * @param data Data to compress
+ * @param data_size Size of the data, at most MAX_BLOCK_DATA_SIZE
+ * @param dest Destination for the block, with room for MAX_BLOCK_SIZE bytes
+ * @return Total size of the block, in bytes
+ *
+ * @throws std::runtime_error if compression fails.
+ */
+size_t deflate_block(
+    z_stream* strm, const uint8_t* data, size_t data_size, uint8_t* dest);
+
+}  // namespace bgzf
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_BGZF_H
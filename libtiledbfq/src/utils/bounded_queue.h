@@ -0,0 +1,145 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_BOUNDED_QUEUE_H
+#define TILEDB_FASTQ_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace tiledb {
+namespace fq {
+
+/**
+ * A simple thread-safe FIFO queue with a fixed capacity, used to connect the
+ * stages of a pipeline. Producers block while the queue is full and consumers
+ * block while it is empty.
+ *
+ * Closing the queue wakes up all waiting threads: pushes then fail, and pops
+ * fail once the remaining elements have been drained.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity)
+      : capacity_(capacity)
+      , closed_(false)
+      , pop_wait_ns_(nullptr) {
+  }
+
+  /** Unimplemented rule-of-5. */
+  BoundedQueue(BoundedQueue&&) = delete;
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(BoundedQueue&&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * Pushes a value, blocking while the queue is full.
+   *
+   * @return False if the queue was closed and the value was not pushed.
+   */
+  bool push(T value) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    not_full_.wait(
+        lck, [this]() { return closed_ || queue_.size() < capacity_; });
+    if (closed_)
+      return false;
+    queue_.push_back(std::move(value));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * Pops a value, blocking while the queue is empty.
+   *
+   * @return False if the queue was closed and is empty.
+   */
+  bool pop(T* value) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    auto ready = [this]() { return closed_ || !queue_.empty(); };
+    if (!ready()) {
+      const auto start = std::chrono::steady_clock::now();
+      not_empty_.wait(lck, ready);
+      if (pop_wait_ns_ != nullptr)
+        *pop_wait_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    }
+    if (queue_.empty())
+      return false;
+    *value = std::move(queue_.front());
+    queue_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /** Closes the queue, waking up all waiting threads. */
+  void close() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  /**
+   * Sets a counter of the nanoseconds pops spend waiting for values, which
+   * measures how often the consumers stall on the producers.
+   */
+  void set_pop_wait_timer(std::atomic<uint64_t>* pop_wait_ns) {
+    pop_wait_ns_ = pop_wait_ns;
+  }
+
+  /** Returns the number of values currently in the queue. */
+  size_t size() const {
+    std::unique_lock<std::mutex> lck(mtx_);
+    return queue_.size();
+  }
+
+ private:
+  size_t capacity_;
+
+  bool closed_;
+
+  std::deque<T> queue_;
+
+  mutable std::mutex mtx_;
+
+  std::condition_variable not_empty_;
+
+  std::condition_variable not_full_;
+
+  /** Counter of the time pops spend waiting, or null. */
+  std::atomic<uint64_t>* pop_wait_ns_;
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_BOUNDED_QUEUE_H
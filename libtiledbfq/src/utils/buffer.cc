@@ -33,13 +33,15 @@ namespace fq {
 
 Buffer::Buffer()
     : expecting_(false)
+    , view_(false)
     , data_(nullptr)
     , data_alloced_size_(0)
     , data_size_(0) {
 }
 
 Buffer::~Buffer() {
-  std::free(data_);
+  if (!view_)
+    std::free(data_);
 }
 
 Buffer::Buffer(Buffer&& other)
@@ -49,6 +51,7 @@ Buffer::Buffer(Buffer&& other)
 
 Buffer::Buffer(const Buffer& other) {
   expecting_ = other.expecting_;
+  view_ = false;
   data_ = nullptr;
   data_alloced_size_ = 0;
   data_size_ = other.data_size_;
@@ -96,6 +99,11 @@ void Buffer::append(const void* data, size_t bytes) {
 void Buffer::clear() {
   offsets_.clear();
   data_size_ = 0;
+  if (view_) {
+    view_ = false;
+    data_ = nullptr;
+    data_alloced_size_ = 0;
+  }
 }
 
 void Buffer::reserve(size_t s, bool clear_new) {
@@ -133,18 +141,20 @@ size_t Buffer::alloced_size() const {
   return data_alloced_size_;
 }
 
-void Buffer::set_query_buffer(const std::string& attr, tiledb::Query& q) {
-  q.set_buffer(
-      attr, offsets_.data(), offsets_.size(), (uint8_t*)data_, data_size_);
-}
-
 void Buffer::realloc(uint64_t new_alloced_size, bool clear_new) {
   if (new_alloced_size == 0)
     return;
 
   auto old_alloc = data_alloced_size_;
 
-  if (data_alloced_size_ == 0) {
+  if (view_) {
+    // Copy the view out to an allocation of the buffer's own.
+    char* data = (char*)std::malloc(new_alloced_size);
+    std::memcpy(data, data_, data_size_);
+    view_ = false;
+    data_ = data;
+    data_alloced_size_ = new_alloced_size;
+  } else if (data_alloced_size_ == 0) {
     data_alloced_size_ = new_alloced_size;
     data_ = (char*)std::realloc(data_, data_alloced_size_);
   } else if (new_alloced_size > data_alloced_size_) {
@@ -164,11 +174,26 @@ void Buffer::realloc(uint64_t new_alloced_size, bool clear_new) {
 
 void Buffer::swap(Buffer& other) {
   std::swap(expecting_, other.expecting_);
+  std::swap(view_, other.view_);
   std::swap(data_, other.data_);
   std::swap(data_alloced_size_, other.data_alloced_size_);
   std::swap(data_size_, other.data_size_);
   offsets_.swap(other.offsets_);
 }
 
+void Buffer::set_view(const char* data, size_t size) {
+  if (!view_)
+    std::free(data_);
+  offsets_.clear();
+  view_ = true;
+  data_ = const_cast<char*>(data);
+  data_alloced_size_ = size;
+  data_size_ = size;
+}
+
+bool Buffer::is_view() const {
+  return view_;
+}
+
 }  // namespace fq
 }  // namespace tiledb
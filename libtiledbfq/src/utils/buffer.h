@@ -79,7 +79,11 @@ class Buffer {
 
   size_t alloced_size() const;
 
-  void set_query_buffer(const std::string& attr, tiledb::Query& q);
+  /** Sets the data and offsets as the buffers of a var-length attribute. */
+  template <typename T = uint8_t>
+  void set_query_buffer(const std::string& attr, tiledb::Query& q) {
+    q.set_buffer(attr, offsets_.data(), offsets_.size(), data<T>(), nelts<T>());
+  }
 
   template <typename T>
   T* data() const {
@@ -101,9 +105,22 @@ class Buffer {
 
   void swap(Buffer& other);
 
+  /**
+   * Points the buffer at memory it does not own, such as a file mapping,
+   * instead of its own allocation. The view is read-only: clearing the buffer
+   * or growing it past the view gives it its own allocation again.
+   */
+  void set_view(const char* data, size_t size);
+
+  /** Returns true if the buffer points at memory it does not own. */
+  bool is_view() const;
+
  private:
   bool expecting_;
 
+  /** True if data_ is not owned by the buffer, see set_view(). */
+  bool view_;
+
   char* data_;
 
   uint64_t data_alloced_size_;
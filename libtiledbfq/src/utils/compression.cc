@@ -0,0 +1,233 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utils/compression.h"
+#include "utils/utils.h"
+
+namespace tiledb {
+namespace fq {
+namespace compression {
+
+namespace {
+const std::vector<std::pair<std::string, tiledb_filter_type_t>> FILTER_NAMES = {
+    {"gzip", TILEDB_FILTER_GZIP},
+    {"zstd", TILEDB_FILTER_ZSTD},
+    {"lz4", TILEDB_FILTER_LZ4},
+    {"rle", TILEDB_FILTER_RLE},
+    {"bzip2", TILEDB_FILTER_BZIP2},
+    {"double_delta", TILEDB_FILTER_DOUBLE_DELTA},
+    {"positive_delta", TILEDB_FILTER_POSITIVE_DELTA},
+    {"bit_width_reduction", TILEDB_FILTER_BIT_WIDTH_REDUCTION},
+    {"bitshuffle", TILEDB_FILTER_BITSHUFFLE},
+    {"byteshuffle", TILEDB_FILTER_BYTESHUFFLE}};
+
+/**
+ * Returns true if the filter takes a compression level. RLE is a compressor,
+ * but has no levels.
+ */
+bool is_compressor(tiledb_filter_type_t type) {
+  switch (type) {
+    case TILEDB_FILTER_GZIP:
+    case TILEDB_FILTER_ZSTD:
+    case TILEDB_FILTER_LZ4:
+    case TILEDB_FILTER_BZIP2:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string filter_name(tiledb_filter_type_t type) {
+  for (const auto& f : FILTER_NAMES)
+    if (f.second == type)
+      return f.first;
+  throw std::runtime_error("Unknown filter type " + std::to_string(type));
+}
+
+/** Returns a preset with the same pipeline on every attribute. */
+Config make_preset(
+    const std::string& name,
+    const Pipeline& pipeline,
+    const Pipeline& offsets) {
+  Config config;
+  config.preset = name;
+  for (const auto& attr : pipeline_names())
+    config.pipelines[attr] = pipeline;
+  config.pipelines.erase(OFFSETS);
+  if (!offsets.empty())
+    config.pipelines[OFFSETS] = offsets;
+  return config;
+}
+}  // namespace
+
+std::vector<std::string> pipeline_names() {
+  return {"header", "sequence", "description", "quality", OFFSETS};
+}
+
+std::vector<std::string> preset_names() {
+  return {"fast-ingest", "balanced", "archive", "bzip2"};
+}
+
+Config preset(const std::string& name) {
+  // Offsets grow by roughly the same amount from cell to cell, so that their
+  // double deltas are small and compress well.
+  if (name == "fast-ingest")
+    return make_preset(
+        name,
+        {{TILEDB_FILTER_LZ4, -1}},
+        {{TILEDB_FILTER_DOUBLE_DELTA, -1}, {TILEDB_FILTER_LZ4, -1}});
+  if (name == "balanced")
+    return make_preset(
+        name,
+        {{TILEDB_FILTER_ZSTD, 3}},
+        {{TILEDB_FILTER_DOUBLE_DELTA, -1}, {TILEDB_FILTER_ZSTD, 3}});
+  if (name == "archive") {
+    Config config = make_preset(
+        name,
+        {{TILEDB_FILTER_ZSTD, 19}},
+        {{TILEDB_FILTER_DOUBLE_DELTA, -1}, {TILEDB_FILTER_ZSTD, 19}});
+    // BZIP2 still compresses quality scores best.
+    config.pipelines["quality"] = {{TILEDB_FILTER_BZIP2, 9}};
+    return config;
+  }
+  if (name == "bzip2")
+    return make_preset(name, {{TILEDB_FILTER_BZIP2, -1}}, {});
+
+  const auto names = preset_names();
+  std::string list;
+  for (const auto& n : names)
+    list += (list.empty() ? "'" : ", '") + n + "'";
+  throw std::runtime_error(
+      "Unknown compression preset '" + name + "'; expected one of " + list +
+      ".");
+}
+
+Pipeline parse_pipeline(const std::string& spec) {
+  Pipeline pipeline;
+  if (spec == "none")
+    return pipeline;
+  // Empty entries are errors, so split by hand rather than with utils::split.
+  for (size_t begin = 0; begin <= spec.size();) {
+    const size_t end = std::min(spec.find('+', begin), spec.size());
+    const std::string entry = spec.substr(begin, end - begin);
+    begin = end + 1;
+
+    const size_t colon = entry.find(':');
+    const std::string name = entry.substr(0, colon);
+    auto it = std::find_if(
+        FILTER_NAMES.begin(),
+        FILTER_NAMES.end(),
+        [&name](const std::pair<std::string, tiledb_filter_type_t>& f) {
+          return f.first == name;
+        });
+    if (it == FILTER_NAMES.end())
+      throw std::runtime_error(
+          "Error parsing filter pipeline '" + spec + "'; unknown filter '" +
+          name + "'");
+
+    FilterSpec filter = {it->second, -1};
+    if (colon != std::string::npos) {
+      const std::string level = entry.substr(colon + 1);
+      if (!is_compressor(filter.type))
+        throw std::runtime_error(
+            "Error parsing filter pipeline '" + spec + "'; filter '" + name +
+            "' does not take a level; levels are only supported by gzip, "
+            "zstd, lz4 and bzip2");
+      try {
+        size_t pos;
+        filter.level = std::stoi(level, &pos);
+        if (pos != level.size())
+          throw std::invalid_argument(entry);
+      } catch (const std::logic_error&) {
+        throw std::runtime_error(
+            "Error parsing filter pipeline '" + spec + "'; invalid level '" +
+            level + "'");
+      }
+    }
+    pipeline.push_back(filter);
+  }
+  return pipeline;
+}
+
+std::string to_string(const Pipeline& pipeline) {
+  if (pipeline.empty())
+    return "none";
+  std::string spec;
+  for (const auto& filter : pipeline) {
+    if (!spec.empty())
+      spec += "+";
+    spec += filter_name(filter.type);
+    if (filter.level != -1)
+      spec += ":" + std::to_string(filter.level);
+  }
+  return spec;
+}
+
+void apply_overrides(const std::string& overrides, Config* config) {
+  const auto names = pipeline_names();
+  for (const auto& entry : utils::split(overrides, ",")) {
+    const size_t eq = entry.find('=');
+    if (eq == std::string::npos)
+      throw std::runtime_error(
+          "Error parsing filter override '" + entry +
+          "'; expected NAME=PIPELINE");
+    const std::string name = entry.substr(0, eq);
+    if (std::find(names.begin(), names.end(), name) == names.end())
+      throw std::runtime_error(
+          "Error parsing filter override '" + entry + "'; unknown name '" +
+          name + "'");
+    config->pipelines[name] = parse_pipeline(entry.substr(eq + 1));
+  }
+}
+
+std::string to_string(const Config& config) {
+  std::string spec;
+  for (const auto& p : config.pipelines) {
+    if (!spec.empty())
+      spec += ",";
+    spec += p.first + "=" + to_string(p.second);
+  }
+  return spec;
+}
+
+tiledb::FilterList make_filter_list(
+    const tiledb::Context& ctx, const Pipeline& pipeline) {
+  tiledb::FilterList filters(ctx);
+  for (const auto& spec : pipeline) {
+    tiledb::Filter filter(ctx, spec.type);
+    if (spec.level != -1)
+      filter.set_option(TILEDB_COMPRESSION_LEVEL, int32_t(spec.level));
+    filters.add_filter(filter);
+  }
+  return filters;
+}
+
+}  // namespace compression
+}  // namespace fq
+}  // namespace tiledb
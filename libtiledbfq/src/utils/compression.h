@@ -0,0 +1,129 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_COMPRESSION_H
+#define TILEDB_FASTQ_COMPRESSION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <tiledb/tiledb>
+
+namespace tiledb {
+namespace fq {
+namespace compression {
+
+/**
+ * Filter pipelines of the array attributes. A pipeline is written as the
+ * names of its filters joined by '+', applied in order, where the gzip, zstd,
+ * lz4 and bzip2 compressors may take a level after a ':'; e.g.
+ * "double_delta+zstd:3". "none" is the empty pipeline.
+ *
+ * A configuration starts from a named preset, whose pipelines can be
+ * overridden per attribute with comma-separated "NAME=PIPELINE" entries,
+ * e.g. "quality=zstd:9,header=lz4". The name "offsets" stands for the offsets
+ * of all var-length attributes, which share a pipeline.
+ */
+
+/** Name of the pipeline of the var-length offsets. */
+const std::string OFFSETS = "offsets";
+
+/** A filter of a pipeline. */
+struct FilterSpec {
+  tiledb_filter_type_t type;
+  /** Compression level, or -1 for the compressor's default. */
+  int level;
+};
+
+/** A filter pipeline, in the order the filters are applied. */
+typedef std::vector<FilterSpec> Pipeline;
+
+/** The pipelines of an array. */
+struct Config {
+  /** Name of the preset the pipelines started from. */
+  std::string preset;
+  /**
+   * Pipeline of each attribute and of the offsets. Attributes without a
+   * pipeline are left to TileDB's defaults.
+   */
+  std::map<std::string, Pipeline> pipelines;
+};
+
+/** Returns the names of the pipelines: the attributes, then the offsets. */
+std::vector<std::string> pipeline_names();
+
+/** Returns the names of the presets. */
+std::vector<std::string> preset_names();
+
+/**
+ * Returns the pipelines of a preset:
+ *  - "fast-ingest": LZ4, for the fastest ingestion and export.
+ *  - "balanced": zstd level 3, smaller than BZIP2 and much faster.
+ *  - "archive": zstd level 19, with BZIP2 for the quality scores, for the
+ *    smallest arrays.
+ *  - "bzip2": BZIP2 on every attribute, as in arrays created before presets.
+ * The offsets are delta-encoded before compression, except in "bzip2".
+ *
+ * @throws std::runtime_error if there is no such preset.
+ */
+Config preset(const std::string& name);
+
+/**
+ * Parses a pipeline.
+ *
+ * @throws std::runtime_error if the pipeline is malformed.
+ */
+Pipeline parse_pipeline(const std::string& spec);
+
+/** Returns the string form of a pipeline, as accepted by parse_pipeline(). */
+std::string to_string(const Pipeline& pipeline);
+
+/**
+ * Overrides pipelines of a configuration.
+ *
+ * @param overrides Comma-separated "NAME=PIPELINE" entries
+ * @param config Configuration to update
+ *
+ * @throws std::runtime_error if an entry is malformed or has an unknown name.
+ */
+void apply_overrides(const std::string& overrides, Config* config);
+
+/**
+ * Returns the pipelines of a configuration as comma-separated
+ * "NAME=PIPELINE" entries, as accepted by apply_overrides().
+ */
+std::string to_string(const Config& config);
+
+/** Builds a TileDB filter list from a pipeline. */
+tiledb::FilterList make_filter_list(
+    const tiledb::Context& ctx, const Pipeline& pipeline);
+
+}  // namespace compression
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_COMPRESSION_H
@@ -0,0 +1,163 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "utils/descriptions.h"
+
+namespace tiledb {
+namespace fq {
+namespace descriptions {
+
+namespace {
+/** Largest record number in the array. */
+const uint64_t DIM_MAX = (uint64_t(1) << 62) - 1;
+
+const std::string RECORD_DIM = "record";
+const std::string DESCRIPTION_ATTR = "description";
+}  // namespace
+
+std::string array_uri(const std::string& array_uri) {
+  std::string uri = array_uri;
+  while (!uri.empty() && uri.back() == '/')
+    uri.pop_back();
+  return uri + "/descriptions";
+}
+
+Kind kind(
+    const char* header,
+    size_t header_size,
+    const char* description,
+    size_t description_size) {
+  if (description_size == 0)
+    return Kind::Empty;
+  if (description_size == header_size &&
+      std::memcmp(header, description, header_size) == 0)
+    return Kind::SameAsHeader;
+  return Kind::Explicit;
+}
+
+void create(
+    const tiledb::Context& ctx,
+    const std::string& uri,
+    const tiledb::FilterList& filters) {
+  auto record = tiledb::Dimension::create<uint64_t>(
+      ctx, RECORD_DIM, {{0, DIM_MAX}}, DIM_MAX);
+  tiledb::Domain dom(ctx);
+  dom.add_dimension(record);
+
+  auto description = tiledb::Attribute::create<std::vector<char>>(
+      ctx, DESCRIPTION_ATTR, filters);
+
+  tiledb::ArraySchema schema(ctx, TILEDB_SPARSE);
+  schema.set_domain(dom);
+  schema.set_cell_order(TILEDB_ROW_MAJOR).set_tile_order(TILEDB_ROW_MAJOR);
+  schema.add_attribute(description);
+  tiledb::Array::create(uri, schema);
+}
+
+void write(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    uint64_t record_start,
+    const std::vector<uint64_t>& indices,
+    Buffer* descriptions) {
+  if (indices.empty())
+    return;
+  std::vector<uint64_t> coords(indices.size());
+  for (size_t i = 0; i < indices.size(); i++)
+    coords[i] = record_start + indices[i];
+
+  tiledb::Query query(ctx, array);
+  query.set_layout(TILEDB_UNORDERED).set_coordinates(coords);
+  descriptions->set_query_buffer<char>(DESCRIPTION_ATTR, query);
+  query.submit();
+}
+
+void read(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    const std::vector<uint64_t>& records,
+    Buffer* descriptions) {
+  descriptions->clear();
+  if (records.empty())
+    return;
+
+  // One range per run of consecutive records, read in a single query.
+  tiledb::Query query(ctx, array);
+  query.set_layout(TILEDB_UNORDERED);
+  size_t run_start = 0;
+  for (size_t i = 1; i <= records.size(); i++) {
+    if (i == records.size() || records[i] != records[i - 1] + 1) {
+      query.add_range(0, records[run_start], records[i - 1]);
+      run_start = i;
+    }
+  }
+
+  const uint64_t est_bytes = query.est_result_size_var(DESCRIPTION_ATTR).second;
+  std::vector<uint64_t> coords(records.size());
+  std::vector<uint64_t> offsets(records.size());
+  std::vector<char> data(std::max<uint64_t>(est_bytes, 1024));
+
+  std::vector<std::pair<uint64_t, std::string>> cells;
+  cells.reserve(records.size());
+  auto status = tiledb::Query::Status::INCOMPLETE;
+  while (status == tiledb::Query::Status::INCOMPLETE) {
+    query.set_coordinates(coords).set_buffer(DESCRIPTION_ATTR, offsets, data);
+    status = query.submit();
+    if (status == tiledb::Query::Status::FAILED)
+      throw std::runtime_error("Error reading descriptions; query failed");
+
+    const auto results = query.result_buffer_elements()[DESCRIPTION_ATTR];
+    const uint64_t num_cells = results.first;
+    if (num_cells == 0 && status == tiledb::Query::Status::INCOMPLETE) {
+      data.resize(2 * data.size());
+      continue;
+    }
+    for (uint64_t i = 0; i < num_cells; i++) {
+      const uint64_t end = i + 1 < num_cells ? offsets[i + 1] : results.second;
+      cells.emplace_back(
+          coords[i], std::string(data.data() + offsets[i], end - offsets[i]));
+    }
+  }
+
+  std::sort(cells.begin(), cells.end());
+  for (size_t i = 0; i < records.size(); i++) {
+    if (i >= cells.size() || cells[i].first != records[i])
+      throw std::runtime_error(
+          "Error reading descriptions; no description for record " +
+          std::to_string(records[i]) + ".");
+    descriptions->offsets().push_back(descriptions->size());
+    descriptions->append(cells[i].second.data(), cells[i].second.size());
+  }
+}
+
+}  // namespace descriptions
+}  // namespace fq
+}  // namespace tiledb
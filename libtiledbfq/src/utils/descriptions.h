@@ -0,0 +1,116 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_DESCRIPTIONS_H
+#define TILEDB_FASTQ_DESCRIPTIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <tiledb/tiledb>
+
+#include "utils/buffer.h"
+
+namespace tiledb {
+namespace fq {
+namespace descriptions {
+
+/*
+ * Storage of the descriptions, the text after the '+' of a record. Nearly
+ * all descriptions are empty or repeat the header, so the array stores the
+ * kind of each description in a uint8 attribute, and only the explicit
+ * descriptions in a sparse array with a 'record' dimension. The sparse array
+ * is stored as a sub-directory of the array.
+ */
+
+/** Kind of a description. */
+enum class Kind : uint8_t {
+  /** No description. */
+  Empty = 0,
+  /** The same text as the header. */
+  SameAsHeader = 1,
+  /** Any other text, stored in the descriptions array. */
+  Explicit = 2
+};
+
+/** Name of the attribute storing the kind of each description. */
+const std::string KIND_ATTRIBUTE = "description_kind";
+
+/** Returns the URI of the descriptions array of the given array. */
+std::string array_uri(const std::string& array_uri);
+
+/** Returns the kind of a description. */
+Kind kind(
+    const char* header,
+    size_t header_size,
+    const char* description,
+    size_t description_size);
+
+/** Creates an empty descriptions array at the given URI. */
+void create(
+    const tiledb::Context& ctx,
+    const std::string& uri,
+    const tiledb::FilterList& filters);
+
+/**
+ * Writes the explicit descriptions of a batch of consecutive records.
+ *
+ * @param array Descriptions array open for writing
+ * @param record_start Number of the first record of the batch
+ * @param indices Indices in the batch of the records with explicit
+ *    descriptions
+ * @param descriptions Var-length buffer of their descriptions, in order
+ */
+void write(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    uint64_t record_start,
+    const std::vector<uint64_t>& indices,
+    Buffer* descriptions);
+
+/**
+ * Reads the explicit descriptions of the given records.
+ *
+ * @param array Descriptions array open for reading
+ * @param records Sorted numbers of records with explicit descriptions
+ * @param descriptions Set to their descriptions, in order, as a var-length
+ *    buffer
+ *
+ * @throws std::runtime_error if a record has no description.
+ */
+void read(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    const std::vector<uint64_t>& records,
+    Buffer* descriptions);
+
+}  // namespace descriptions
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_DESCRIPTIONS_H
@@ -0,0 +1,192 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utils/header_index.h"
+
+namespace tiledb {
+namespace fq {
+namespace header_index {
+
+namespace {
+/** Largest key and record number in the index. */
+const uint64_t DIM_MAX = (uint64_t(1) << 62) - 1;
+
+const std::string KEY_DIM = "key";
+const std::string RECORD_DIM = "record";
+const std::string CHECK_ATTR = "check";
+
+/** 64-bit FNV-1a hash. */
+uint64_t fnv1a(const char* data, size_t size, uint64_t basis) {
+  uint64_t h = basis;
+  for (size_t i = 0; i < size; i++) {
+    h ^= uint8_t(data[i]);
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+/** Finalizer of MurmurHash3, spreading every input bit over the hash. */
+uint64_t mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+bool hash_less(const NameHash& a, const NameHash& b) {
+  return a.key < b.key || (a.key == b.key && a.check < b.check);
+}
+
+bool hash_equal(const NameHash& a, const NameHash& b) {
+  return a.key == b.key && a.check == b.check;
+}
+}  // namespace
+
+std::string index_uri(const std::string& array_uri) {
+  std::string uri = array_uri;
+  while (!uri.empty() && uri.back() == '/')
+    uri.pop_back();
+  return uri + "/header_index";
+}
+
+size_t name_length(const char* header, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (header[i] == ' ' || header[i] == '\t')
+      return i;
+  }
+  return size;
+}
+
+NameHash hash_name(const char* name, size_t size) {
+  NameHash hash;
+  hash.key = mix(fnv1a(name, size, 0xcbf29ce484222325ULL)) & DIM_MAX;
+  hash.check = uint32_t(mix(fnv1a(name, size, 0x84222325cbf29ce4ULL)));
+  return hash;
+}
+
+void create(const tiledb::Context& ctx, const std::string& uri) {
+  // The cells are sorted by key, so the cells of a key are in few data tiles.
+  auto key = tiledb::Dimension::create<uint64_t>(
+      ctx, KEY_DIM, {{0, DIM_MAX}}, uint64_t(1) << 56);
+  auto record = tiledb::Dimension::create<uint64_t>(
+      ctx, RECORD_DIM, {{0, DIM_MAX}}, DIM_MAX);
+  tiledb::Domain dom(ctx);
+  dom.add_dimension(key).add_dimension(record);
+
+  tiledb::FilterList filters(ctx);
+  filters.add_filter(tiledb::Filter(ctx, TILEDB_FILTER_ZSTD));
+  auto check = tiledb::Attribute::create<uint32_t>(ctx, CHECK_ATTR, filters);
+
+  tiledb::ArraySchema schema(ctx, TILEDB_SPARSE);
+  schema.set_domain(dom);
+  schema.set_cell_order(TILEDB_ROW_MAJOR).set_tile_order(TILEDB_ROW_MAJOR);
+  schema.add_attribute(check);
+  tiledb::Array::create(uri, schema);
+}
+
+void write(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    uint64_t record_start,
+    const std::vector<NameHash>& hashes) {
+  if (hashes.empty())
+    return;
+  std::vector<uint64_t> coords(2 * hashes.size());
+  std::vector<uint32_t> checks(hashes.size());
+  for (size_t i = 0; i < hashes.size(); i++) {
+    coords[2 * i] = hashes[i].key;
+    coords[2 * i + 1] = record_start + i;
+    checks[i] = hashes[i].check;
+  }
+
+  tiledb::Query query(ctx, array);
+  query.set_layout(TILEDB_UNORDERED)
+      .set_coordinates(coords)
+      .set_buffer(CHECK_ATTR, checks);
+  query.submit();
+}
+
+std::vector<uint64_t> find(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    const std::vector<NameHash>& hashes) {
+  std::vector<uint64_t> records;
+  if (hashes.empty())
+    return records;
+
+  std::vector<NameHash> sorted(hashes);
+  std::sort(sorted.begin(), sorted.end(), hash_less);
+  sorted.erase(
+      std::unique(sorted.begin(), sorted.end(), hash_equal), sorted.end());
+
+  // One range per key, read in a single query.
+  tiledb::Query query(ctx, array);
+  query.set_layout(TILEDB_UNORDERED);
+  for (size_t i = 0; i < sorted.size(); i++) {
+    if (i == 0 || sorted[i].key != sorted[i - 1].key)
+      query.add_range(0, sorted[i].key, sorted[i].key);
+  }
+  query.add_range(1, uint64_t(0), DIM_MAX);
+
+  const uint64_t est_cells =
+      query.est_result_size(TILEDB_COORDS) / (2 * sizeof(uint64_t));
+  std::vector<uint64_t> coords(2 * std::max<uint64_t>(est_cells, 1024));
+  std::vector<uint32_t> checks(coords.size() / 2);
+
+  auto status = tiledb::Query::Status::INCOMPLETE;
+  while (status == tiledb::Query::Status::INCOMPLETE) {
+    query.set_coordinates(coords).set_buffer(CHECK_ATTR, checks);
+    status = query.submit();
+    if (status == tiledb::Query::Status::FAILED)
+      throw std::runtime_error("Error reading header index; query failed");
+
+    const uint64_t num_cells =
+        query.result_buffer_elements()[CHECK_ATTR].second;
+    if (num_cells == 0 && status == tiledb::Query::Status::INCOMPLETE) {
+      coords.resize(2 * coords.size());
+      checks.resize(2 * checks.size());
+      continue;
+    }
+    for (uint64_t i = 0; i < num_cells; i++) {
+      const NameHash hash = {coords[2 * i], checks[i]};
+      if (std::binary_search(sorted.begin(), sorted.end(), hash, hash_less))
+        records.push_back(coords[2 * i + 1]);
+    }
+  }
+
+  std::sort(records.begin(), records.end());
+  records.erase(std::unique(records.begin(), records.end()), records.end());
+  return records;
+}
+
+}  // namespace header_index
+}  // namespace fq
+}  // namespace tiledb
@@ -0,0 +1,101 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_HEADER_INDEX_H
+#define TILEDB_FASTQ_HEADER_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <tiledb/tiledb>
+
+namespace tiledb {
+namespace fq {
+namespace header_index {
+
+/*
+ * The header index maps read names to the numbers of the records with that
+ * name. It is a sparse array with dimensions (key, record) and a 'check'
+ * attribute, where key and check are independent hashes of the read name.
+ * Looking up a name reads the cells with its key, and keeps the records whose
+ * check also matches. The index is stored as a sub-directory of the array.
+ */
+
+/** Hashes of a read name. */
+struct NameHash {
+  /** Hash locating the name in the index. */
+  uint64_t key;
+  /** Second hash, telling apart names with the same key. */
+  uint32_t check;
+};
+
+/** Returns the URI of the header index of the given array. */
+std::string index_uri(const std::string& array_uri);
+
+/**
+ * Returns the length of the read name at the start of the given header,
+ * which is the header up to its first space or tab.
+ */
+size_t name_length(const char* header, size_t size);
+
+/** Returns the hashes of the given read name. */
+NameHash hash_name(const char* name, size_t size);
+
+/** Creates an empty header index array at the given URI. */
+void create(const tiledb::Context& ctx, const std::string& uri);
+
+/**
+ * Writes index entries for a batch of consecutive records.
+ *
+ * @param array Index array open for writing
+ * @param record_start Number of the first record of the batch
+ * @param hashes Hashes of the read names of the records, in order
+ */
+void write(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    uint64_t record_start,
+    const std::vector<NameHash>& hashes);
+
+/**
+ * Finds the records whose read name has one of the given hashes.
+ *
+ * @param array Index array open for reading
+ * @param hashes Hashes of the names to find
+ * @return Sorted numbers of the records found
+ */
+std::vector<uint64_t> find(
+    const tiledb::Context& ctx,
+    const tiledb::Array& array,
+    const std::vector<NameHash>& hashes);
+
+}  // namespace header_index
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_HEADER_INDEX_H
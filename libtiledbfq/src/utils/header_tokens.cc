@@ -0,0 +1,276 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include "utils/header_tokens.h"
+#include "utils/utils.h"
+
+namespace tiledb {
+namespace fq {
+namespace header_tokens {
+
+namespace {
+/**
+ * Splits a header at the delimiters.
+ *
+ * @param header Header to split
+ * @param values Set to the fields
+ * @param delimiters Set to the delimiter after each field, '\0' if none
+ */
+void tokenize(
+    const std::string& header,
+    std::vector<std::string>* values,
+    std::string* delimiters) {
+  values->clear();
+  delimiters->clear();
+  utils::for_each_token(
+      header.cbegin(),
+      header.cend(),
+      DELIMITERS.cbegin(),
+      DELIMITERS.cend(),
+      [&](std::string::const_iterator first,
+          std::string::const_iterator second) {
+        values->emplace_back(first, second);
+        delimiters->push_back(second == header.cend() ? '\0' : *second);
+      });
+}
+
+/**
+ * Parses a field as an integer. Fields with leading zeros or more than 19
+ * digits are not integers, so that every integer fits in a uint64 and
+ * prints back as the same field.
+ */
+bool parse_integer(const char* data, size_t size, uint64_t* value) {
+  if (size == 0 || size > 19 || (size > 1 && data[0] == '0'))
+    return false;
+  uint64_t v = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (data[i] < '0' || data[i] > '9')
+      return false;
+    v = v * 10 + uint64_t(data[i] - '0');
+  }
+  *value = v;
+  return true;
+}
+}  // namespace
+
+std::vector<Field> infer(const std::vector<std::string>& headers) {
+  // Headers of other shapes than the most common one are stored verbatim.
+  std::map<std::string, std::vector<std::vector<std::string>>> shapes;
+  std::vector<std::string> values;
+  std::string delimiters;
+  for (const auto& header : headers) {
+    tokenize(header, &values, &delimiters);
+    shapes[delimiters].push_back(values);
+  }
+  auto shape = shapes.cend();
+  for (auto it = shapes.cbegin(); it != shapes.cend(); ++it) {
+    if (shape == shapes.cend() || it->second.size() > shape->second.size())
+      shape = it;
+  }
+  if (shape == shapes.cend())
+    return {};
+
+  const auto& samples = shape->second;
+  std::vector<Field> fields;
+  bool columnar = false;
+  for (size_t f = 0; f < shape->first.size(); f++) {
+    bool constant = true, integer = true;
+    for (const auto& sample : samples) {
+      uint64_t value;
+      constant = constant && sample[f] == samples[0][f];
+      integer = integer &&
+                parse_integer(sample[f].data(), sample[f].size(), &value);
+    }
+    Field field;
+    field.kind = constant ? FieldKind::Constant :
+                            integer ? FieldKind::Integer : FieldKind::String;
+    if (constant)
+      field.value = samples[0][f];
+    field.delimiter = shape->first[f];
+    columnar = columnar || field.kind != FieldKind::String;
+    fields.push_back(field);
+  }
+  if (!columnar)
+    return {};
+  return fields;
+}
+
+std::vector<Field> parse(const std::string& spec) {
+  std::vector<Field> fields;
+  size_t pos = 0;
+  while (pos < spec.size()) {
+    Field field;
+    field.delimiter = '\0';
+    const char kind = spec[pos++];
+    if (kind == 'c') {
+      const size_t end =
+          std::min(spec.find_first_of(DELIMITERS, pos), spec.size());
+      field.kind = FieldKind::Constant;
+      field.value = spec.substr(pos, end - pos);
+      pos = end;
+    } else if (kind == 'i') {
+      field.kind = FieldKind::Integer;
+    } else if (kind == 's') {
+      field.kind = FieldKind::String;
+    } else {
+      throw std::runtime_error(
+          "Error parsing header template '" + spec + "'; unknown field kind '" +
+          std::string(1, kind) + "'");
+    }
+
+    if (pos < spec.size()) {
+      if (DELIMITERS.find(spec[pos]) == std::string::npos)
+        throw std::runtime_error(
+            "Error parsing header template '" + spec +
+            "'; expected a delimiter at position " + std::to_string(pos));
+      field.delimiter = spec[pos++];
+    }
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+std::string to_string(const std::vector<Field>& fields) {
+  std::string spec;
+  for (const auto& field : fields) {
+    switch (field.kind) {
+      case FieldKind::Constant:
+        spec += "c" + field.value;
+        break;
+      case FieldKind::Integer:
+        spec += "i";
+        break;
+      case FieldKind::String:
+        spec += "s";
+        break;
+    }
+    if (field.delimiter != '\0')
+      spec += field.delimiter;
+  }
+  return spec;
+}
+
+std::string attribute_name(size_t field) {
+  return "header_" + std::to_string(field);
+}
+
+bool split(
+    const std::vector<Field>& fields,
+    const char* header,
+    size_t size,
+    Token* tokens) {
+  const char* header_end = header + size;
+  size_t num_tokens = 0;
+  bool match = true;
+  utils::for_each_token(
+      header,
+      header_end,
+      DELIMITERS.data(),
+      DELIMITERS.data() + DELIMITERS.size(),
+      [&](const char* first, const char* second) {
+        if (!match || num_tokens == fields.size()) {
+          match = false;
+          return;
+        }
+        const Field& field = fields[num_tokens];
+        Token& token = tokens[num_tokens++];
+        token.data = first;
+        token.size = size_t(second - first);
+        token.number = 0;
+        const char delimiter = second == header_end ? '\0' : *second;
+        if (delimiter != field.delimiter) {
+          match = false;
+          return;
+        }
+        switch (field.kind) {
+          case FieldKind::Constant:
+            match = token.size == field.value.size() &&
+                    std::memcmp(first, field.value.data(), token.size) == 0;
+            break;
+          case FieldKind::Integer:
+            match = parse_integer(first, token.size, &token.number);
+            break;
+          case FieldKind::String:
+            match = token.size > 0;
+            break;
+        }
+      });
+  return match && num_tokens == fields.size();
+}
+
+size_t max_joined_size(const std::vector<Field>& fields) {
+  size_t size = 0;
+  for (const auto& field : fields) {
+    if (field.kind == FieldKind::Constant)
+      size += field.value.size();
+    else if (field.kind == FieldKind::Integer)
+      size += 20;
+    if (field.delimiter != '\0')
+      size++;
+  }
+  return size;
+}
+
+char* join(const std::vector<Field>& fields, const Token* tokens, char* out) {
+  for (size_t f = 0; f < fields.size(); f++) {
+    const Field& field = fields[f];
+    switch (field.kind) {
+      case FieldKind::Constant:
+        std::memcpy(out, field.value.data(), field.value.size());
+        out += field.value.size();
+        break;
+      case FieldKind::Integer: {
+        char digits[20];
+        char* p = digits + sizeof(digits);
+        uint64_t value = tokens[f].number;
+        do {
+          *--p = char('0' + value % 10);
+          value /= 10;
+        } while (value > 0);
+        const size_t num_digits = size_t(digits + sizeof(digits) - p);
+        std::memcpy(out, p, num_digits);
+        out += num_digits;
+        break;
+      }
+      case FieldKind::String:
+        std::memcpy(out, tokens[f].data, tokens[f].size);
+        out += tokens[f].size;
+        break;
+    }
+    if (field.delimiter != '\0')
+      *out++ = field.delimiter;
+  }
+  return out;
+}
+
+}  // namespace header_tokens
+}  // namespace fq
+}  // namespace tiledb
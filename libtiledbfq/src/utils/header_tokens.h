@@ -0,0 +1,148 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_HEADER_TOKENS_H
+#define TILEDB_FASTQ_HEADER_TOKENS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tiledb {
+namespace fq {
+namespace header_tokens {
+
+/*
+ * Columnar storage of read headers. A header is split into fields at any of
+ * DELIMITERS; e.g. the Illumina header
+ * "A00123:8:H7KXX:1:1101:1000:2000 1:N:0:ACGT" has 11 fields. A template,
+ * inferred from a sample of the headers, gives the kind of each field and
+ * the delimiter after it. Constant fields are stored once, in the template
+ * recorded in the array metadata. Integer fields are stored in uint64
+ * attributes, and other fields in var-length char attributes, named by
+ * attribute_name().
+ *
+ * Headers that do not match the template are stored verbatim in the header
+ * attribute, and matching headers store MATCHED_HEADER there instead. A
+ * template is written as the kind of each field ('c' followed by the value
+ * for constants, 'i' for integers, 's' for strings) followed by the
+ * delimiter after it, e.g. "cA00123:c8:cH7KXX:i:i:i:i ci:cN:c0:s".
+ */
+
+/** Characters separating the fields of a header. */
+const std::string DELIMITERS = " :/._#";
+
+/** Header attribute cell of a header stored as fields. */
+const char MATCHED_HEADER = '\n';
+
+/** Kind of a header field. */
+enum class FieldKind {
+  /** The same value in every header. */
+  Constant,
+  /** A non-negative decimal integer, without leading zeros. */
+  Integer,
+  /** Any other non-empty value. */
+  String
+};
+
+/** A field of a header template. */
+struct Field {
+  FieldKind kind;
+  /** Value of a constant field. */
+  std::string value;
+  /** Delimiter after the field, or '\0' for the last field. */
+  char delimiter;
+};
+
+/** A field of a header split by split(). */
+struct Token {
+  const char* data;
+  size_t size;
+  /** Value of an integer field. */
+  uint64_t number;
+};
+
+/**
+ * Infers a template from a sample of headers. Headers are split as by
+ * split(), and the fields with the same value in every header of the most
+ * common shape are constants.
+ *
+ * @return The template, or an empty template if no headers have constant or
+ *    integer fields.
+ */
+std::vector<Field> infer(const std::vector<std::string>& headers);
+
+/**
+ * Parses a template.
+ *
+ * @throws std::runtime_error if the template is malformed.
+ */
+std::vector<Field> parse(const std::string& spec);
+
+/** Returns the string form of a template, as accepted by parse(). */
+std::string to_string(const std::vector<Field>& fields);
+
+/** Returns the name of the attribute storing the given field. */
+std::string attribute_name(size_t field);
+
+/**
+ * Splits a header into the fields of a template.
+ *
+ * @param fields Template
+ * @param header Header, without the '@'
+ * @param size Size of the header
+ * @param tokens Set to each field of the header, pointing into the header.
+ *    Has room for one token per field.
+ * @return False if the header does not match the template.
+ */
+bool split(
+    const std::vector<Field>& fields,
+    const char* header,
+    size_t size,
+    Token* tokens);
+
+/**
+ * Returns the maximum size of a header joined from the fields of a template,
+ * not counting its string fields.
+ */
+size_t max_joined_size(const std::vector<Field>& fields);
+
+/**
+ * Joins the fields of a header into the original header.
+ *
+ * @param fields Template
+ * @param tokens Values of the fields, for the integer and string fields
+ * @param out Set to the header
+ * @return One past the end of the header
+ */
+char* join(const std::vector<Field>& fields, const Token* tokens, char* out);
+
+}  // namespace header_tokens
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_HEADER_TOKENS_H
@@ -0,0 +1,104 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdexcept>
+
+#include "utils/quality_bins.h"
+#include "utils/utils.h"
+
+namespace tiledb {
+namespace fq {
+namespace quality_bins {
+
+std::vector<Bin> illumina8() {
+  // No-call (0-2), 3-9, 10-19, 20-24, 25-29, 30-34, 35-39, 40 and above.
+  return {{0, 2},
+          {3, 6},
+          {10, 15},
+          {20, 22},
+          {25, 27},
+          {30, 33},
+          {35, 37},
+          {40, 40}};
+}
+
+std::vector<Bin> parse(const std::string& spec) {
+  std::vector<Bin> bins;
+  for (const auto& entry : utils::split(spec, ",")) {
+    const auto fields = utils::split(entry, ":");
+    unsigned long min_score, value;
+    try {
+      if (fields.size() != 2)
+        throw std::invalid_argument(entry);
+      size_t pos0, pos1;
+      min_score = std::stoul(fields[0], &pos0);
+      value = std::stoul(fields[1], &pos1);
+      if (pos0 != fields[0].size() || pos1 != fields[1].size())
+        throw std::invalid_argument(entry);
+    } catch (const std::logic_error&) {
+      throw std::runtime_error(
+          "Error parsing quality bins '" + spec + "'; invalid bin '" + entry +
+          "', expected MIN:VALUE");
+    }
+    if (min_score > MAX_SCORE || value > MAX_SCORE)
+      throw std::runtime_error(
+          "Error parsing quality bins '" + spec + "'; scores must be at most " +
+          std::to_string(MAX_SCORE));
+    if (bins.empty() ? min_score != 0 : min_score <= bins.back().min_score)
+      throw std::runtime_error(
+          "Error parsing quality bins '" + spec +
+          "'; bins must start at 0 and be in increasing order");
+    bins.push_back({uint8_t(min_score), uint8_t(value)});
+  }
+  if (bins.empty())
+    throw std::runtime_error(
+        "Error parsing quality bins '" + spec + "'; no bins given");
+  return bins;
+}
+
+std::string to_string(const std::vector<Bin>& bins) {
+  std::string result;
+  for (const auto& bin : bins) {
+    if (!result.empty())
+      result += ",";
+    result +=
+        std::to_string(bin.min_score) + ":" + std::to_string(bin.value);
+  }
+  return result;
+}
+
+void make_index_table(const std::vector<Bin>& bins, uint8_t* index) {
+  size_t bin = 0;
+  for (unsigned score = 0; score <= MAX_SCORE; score++) {
+    while (bin + 1 < bins.size() && bins[bin + 1].min_score <= score)
+      bin++;
+    index[score] = uint8_t(bin);
+  }
+}
+
+}  // namespace quality_bins
+}  // namespace fq
+}  // namespace tiledb
@@ -0,0 +1,84 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_QUALITY_BINS_H
+#define TILEDB_FASTQ_QUALITY_BINS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tiledb {
+namespace fq {
+namespace quality_bins {
+
+/**
+ * Lossy storage of quality scores. The Phred scores are divided into bins of
+ * consecutive scores, and each score is stored as the index of its bin. On
+ * export, every score in a bin is reported as the value of the bin.
+ *
+ * A bin table is written as comma-separated "MIN:VALUE" pairs, where MIN is
+ * the lowest score in the bin. The first bin starts at 0, and each bin ends
+ * where the next one starts; e.g. "0:2,10:15,20:30".
+ */
+
+/** A bin of quality scores. */
+struct Bin {
+  /** Lowest score in the bin. */
+  uint8_t min_score;
+  /** Score reported for every score in the bin. */
+  uint8_t value;
+};
+
+/** Maximum Phred score representable in a FastQ file. */
+const uint8_t MAX_SCORE = '~' - '!';
+
+/** Returns the Illumina 8-level binning table. */
+std::vector<Bin> illumina8();
+
+/**
+ * Parses a bin table.
+ *
+ * @throws std::runtime_error if the table is malformed.
+ */
+std::vector<Bin> parse(const std::string& spec);
+
+/** Returns the string form of a bin table, as accepted by parse(). */
+std::string to_string(const std::vector<Bin>& bins);
+
+/**
+ * Builds a table mapping each score to the index of its bin.
+ *
+ * @param bins Bin table
+ * @param index Set to the bin index of every score from 0 to MAX_SCORE
+ */
+void make_index_table(const std::vector<Bin>& bins, uint8_t* index);
+
+}  // namespace quality_bins
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_QUALITY_BINS_H
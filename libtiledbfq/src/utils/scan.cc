@@ -0,0 +1,205 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TILEDB_FASTQ_X86
+#include <immintrin.h>
+#endif
+
+#include "utils/scan.h"
+
+namespace tiledb {
+namespace fq {
+namespace scan {
+
+namespace {
+
+/** Number of bytes examined per block. */
+const size_t BLOCK_SIZE = 32;
+
+/** Returns a bitmask of the newlines in a block of BLOCK_SIZE bytes. */
+typedef uint32_t (*NewlineMaskFn)(const char* p);
+
+uint32_t newline_mask_scalar(const char* p) {
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < BLOCK_SIZE; i++)
+    mask |= uint32_t(p[i] == '\n') << i;
+  return mask;
+}
+
+#ifdef TILEDB_FASTQ_X86
+__attribute__((target("sse2"))) uint32_t newline_mask_sse2(const char* p) {
+  const __m128i nl = _mm_set1_epi8('\n');
+  const __m128i lo = _mm_loadu_si128((const __m128i*)p);
+  const __m128i hi = _mm_loadu_si128((const __m128i*)(p + 16));
+  return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, nl))) |
+         (uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, nl))) << 16);
+}
+
+__attribute__((target("avx2"))) uint32_t newline_mask_avx2(const char* p) {
+  const __m256i nl = _mm256_set1_epi8('\n');
+  const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+  return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+}
+#endif
+
+NewlineMaskFn newline_mask_fn() {
+#ifdef TILEDB_FASTQ_X86
+  if (__builtin_cpu_supports("avx2"))
+    return newline_mask_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return newline_mask_sse2;
+#endif
+  return newline_mask_scalar;
+}
+
+/** Returns the newline bitmask of a block, which may be partial. */
+uint32_t newline_mask(const char* p, const char* end) {
+  static const NewlineMaskFn mask_fn = newline_mask_fn();
+  if (end - p >= (ptrdiff_t)BLOCK_SIZE)
+    return mask_fn(p);
+  char block[BLOCK_SIZE] = {0};
+  std::memcpy(block, p, end - p);
+  return mask_fn(block);
+}
+
+/** Index of the lowest set bit of a nonzero mask. */
+inline unsigned lowest_bit(uint32_t mask) {
+  return unsigned(__builtin_ctz(mask));
+}
+
+/** Converts quality characters, returning false if any is out of range. */
+bool quality_scores_scalar(const char* src, size_t size, uint8_t* dest) {
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < size; i++) {
+    const uint8_t score = uint8_t(src[i] - '!');
+    invalid |= uint8_t(score > '~' - '!');
+    dest[i] = score;
+  }
+  return invalid == 0;
+}
+
+#ifdef TILEDB_FASTQ_X86
+__attribute__((target("sse2"))) bool quality_scores_sse2(
+    const char* src, size_t size, uint8_t* dest) {
+  const __m128i offset = _mm_set1_epi8('!');
+  const __m128i max_score = _mm_set1_epi8('~' - '!');
+  __m128i valid = _mm_set1_epi8(-1);
+  const size_t num_blocks = size / 16;
+  for (size_t i = 0; i < num_blocks; i++) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(src + 16 * i));
+    const __m128i scores = _mm_sub_epi8(v, offset);
+    valid = _mm_and_si128(
+        valid,
+        _mm_cmpeq_epi8(_mm_max_epu8(scores, max_score), max_score));
+    _mm_storeu_si128((__m128i*)(dest + 16 * i), scores);
+  }
+  const size_t done = 16 * num_blocks;
+  return _mm_movemask_epi8(valid) == 0xffff &&
+         quality_scores_scalar(src + done, size - done, dest + done);
+}
+
+__attribute__((target("avx2"))) bool quality_scores_avx2(
+    const char* src, size_t size, uint8_t* dest) {
+  const __m256i offset = _mm256_set1_epi8('!');
+  const __m256i max_score = _mm256_set1_epi8('~' - '!');
+  __m256i valid = _mm256_set1_epi8(-1);
+  const size_t num_blocks = size / 32;
+  for (size_t i = 0; i < num_blocks; i++) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)(src + 32 * i));
+    const __m256i scores = _mm256_sub_epi8(v, offset);
+    valid = _mm256_and_si256(
+        valid,
+        _mm256_cmpeq_epi8(_mm256_max_epu8(scores, max_score), max_score));
+    _mm256_storeu_si256((__m256i*)(dest + 32 * i), scores);
+  }
+  const size_t done = 32 * num_blocks;
+  return _mm256_movemask_epi8(valid) == -1 &&
+         quality_scores_scalar(src + done, size - done, dest + done);
+}
+#endif
+
+typedef bool (*QualityScoresFn)(const char* src, size_t size, uint8_t* dest);
+
+QualityScoresFn quality_scores_fn() {
+#ifdef TILEDB_FASTQ_X86
+  if (__builtin_cpu_supports("avx2"))
+    return quality_scores_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return quality_scores_sse2;
+#endif
+  return quality_scores_scalar;
+}
+
+}  // namespace
+
+size_t find_newlines(
+    const char* begin,
+    const char* end,
+    size_t max_count,
+    const char** positions) {
+  size_t count = 0;
+  for (const char* p = begin; p < end && count < max_count; p += BLOCK_SIZE) {
+    uint32_t mask = newline_mask(p, end);
+    while (mask != 0 && count < max_count) {
+      positions[count++] = p + lowest_bit(mask);
+      mask &= mask - 1;
+    }
+  }
+  return count;
+}
+
+const char* find_groups_end(
+    const char* begin, const char* end, unsigned group_lines) {
+  const char* groups_end = begin;
+  unsigned lines = 0;
+  for (const char* p = begin; p < end; p += BLOCK_SIZE) {
+    uint32_t mask = newline_mask(p, end);
+    const unsigned count = unsigned(__builtin_popcount(mask));
+    if (lines + count < group_lines) {
+      lines += count;
+      continue;
+    }
+    for (; mask != 0; mask &= mask - 1) {
+      if (++lines == group_lines) {
+        groups_end = p + lowest_bit(mask) + 1;
+        lines = 0;
+      }
+    }
+  }
+  return groups_end;
+}
+
+bool quality_scores(const char* src, size_t size, uint8_t* dest) {
+  static const QualityScoresFn fn = quality_scores_fn();
+  return fn(src, size, dest);
+}
+
+}  // namespace scan
+}  // namespace fq
+}  // namespace tiledb
@@ -0,0 +1,84 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_SCAN_H
+#define TILEDB_FASTQ_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tiledb {
+namespace fq {
+namespace scan {
+
+/**
+ * Vectorized scanning of FastQ text. On x86 the AVX2 or SSE2 implementation
+ * is picked at runtime; other platforms use the scalar implementation.
+ */
+
+/**
+ * Finds the first newlines in a range.
+ *
+ * @param begin Start of the range
+ * @param end End of the range
+ * @param max_count Maximum number of newlines to find
+ * @param positions Set to the positions of the newlines found
+ * @return Number of newlines found
+ */
+size_t find_newlines(
+    const char* begin,
+    const char* end,
+    size_t max_count,
+    const char** positions);
+
+/**
+ * Finds the end of the last whole group of lines in a range, e.g. the end of
+ * the last whole FastQ record for groups of 4 lines.
+ *
+ * @param begin Start of the range, at the start of a group
+ * @param end End of the range
+ * @param group_lines Number of lines per group
+ * @return Position one past the last newline ending a group, or begin if the
+ *    range has no whole group
+ */
+const char* find_groups_end(
+    const char* begin, const char* end, unsigned group_lines);
+
+/**
+ * Converts Phred+33 quality characters to scores.
+ *
+ * @param src Quality characters
+ * @param size Number of characters
+ * @param dest Set to the scores
+ * @return False if any character is outside of '!'..'~'
+ */
+bool quality_scores(const char* src, size_t size, uint8_t* dest);
+
+}  // namespace scan
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_SCAN_H
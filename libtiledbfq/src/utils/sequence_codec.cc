@@ -0,0 +1,206 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TILEDB_FASTQ_X86
+#include <tmmintrin.h>
+#endif
+
+#include "utils/sequence_codec.h"
+
+namespace tiledb {
+namespace fq {
+namespace sequence_codec {
+
+namespace {
+
+/** Value in the encode table for symbols stored as exceptions. */
+const uint8_t EXCEPTION = 0xff;
+
+/** Lookup tables for encoding single bases and unpacking whole bytes. */
+struct Tables {
+  uint8_t codes[256];
+  char bases[256][4];
+
+  Tables() {
+    const char acgt[4] = {'A', 'C', 'G', 'T'};
+    std::memset(codes, EXCEPTION, sizeof(codes));
+    for (uint8_t i = 0; i < 4; i++)
+      codes[uint8_t(acgt[i])] = i;
+    for (unsigned b = 0; b < 256; b++)
+      for (unsigned i = 0; i < 4; i++)
+        bases[b][i] = acgt[(b >> (2 * i)) & 3];
+  }
+};
+
+const Tables& tables() {
+  static const Tables t;
+  return t;
+}
+
+void unpack_scalar(const uint8_t* packed, size_t num_bases, char* dest) {
+  const Tables& t = tables();
+  const size_t num_whole = num_bases / 4;
+  for (size_t i = 0; i < num_whole; i++)
+    std::memcpy(dest + 4 * i, t.bases[packed[i]], 4);
+  for (size_t i = num_whole * 4; i < num_bases; i++)
+    dest[i] = t.bases[packed[num_whole]][i % 4];
+}
+
+#ifdef TILEDB_FASTQ_X86
+/** Unpacks 64 bases at a time, and the remainder with the scalar path. */
+__attribute__((target("ssse3"))) void unpack_ssse3(
+    const uint8_t* packed, size_t num_bases, char* dest) {
+  // "ACGT" in every 4 bytes.
+  const __m128i lut = _mm_set1_epi32(0x54474341);
+  const __m128i mask = _mm_set1_epi8(3);
+  const size_t num_blocks = num_bases / 64;
+  for (size_t i = 0; i < num_blocks; i++) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(packed + 16 * i));
+    // Bases 4j+k of the block are the 2-bit fields k of the bytes j.
+    const __m128i b0 = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+    const __m128i b1 =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 2), mask));
+    const __m128i b2 =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i b3 =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 6), mask));
+    const __m128i lo01 = _mm_unpacklo_epi8(b0, b1);
+    const __m128i hi01 = _mm_unpackhi_epi8(b0, b1);
+    const __m128i lo23 = _mm_unpacklo_epi8(b2, b3);
+    const __m128i hi23 = _mm_unpackhi_epi8(b2, b3);
+    __m128i* out = (__m128i*)(dest + 64 * i);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(lo01, lo23));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo01, lo23));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi01, hi23));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi01, hi23));
+  }
+  unpack_scalar(
+      packed + 16 * num_blocks,
+      num_bases - 64 * num_blocks,
+      dest + 64 * num_blocks);
+}
+#endif
+
+/** Appends a varint, returning the position past it. */
+uint8_t* write_varint(uint64_t v, uint8_t* dest) {
+  while (v >= 0x80) {
+    *dest++ = uint8_t(v | 0x80);
+    v >>= 7;
+  }
+  *dest++ = uint8_t(v);
+  return dest;
+}
+
+/** Reads a varint, returning the position past it, or null if truncated. */
+const uint8_t* read_varint(const uint8_t* p, const uint8_t* end, uint64_t* v) {
+  *v = 0;
+  for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+    const uint8_t b = *p++;
+    *v |= uint64_t(b & 0x7f) << shift;
+    if ((b & 0x80) == 0)
+      return p;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+size_t packed_size(size_t num_bases) {
+  return (num_bases + 3) / 4;
+}
+
+size_t max_encoded_size(size_t num_bases) {
+  // An exception takes at most 2 bytes per base since the previous one.
+  return packed_size(num_bases) + 2 * num_bases;
+}
+
+size_t encode(const char* bases, size_t num_bases, uint8_t* dest) {
+  const uint8_t* codes = tables().codes;
+  const size_t num_packed = packed_size(num_bases);
+  uint8_t* exceptions = dest + num_packed;
+  size_t next_exception = 0;
+  for (size_t i = 0; i < num_packed; i++) {
+    const size_t start = 4 * i;
+    const size_t n = std::min<size_t>(4, num_bases - start);
+    uint8_t byte = 0;
+    for (size_t j = 0; j < n; j++) {
+      uint8_t code = codes[uint8_t(bases[start + j])];
+      if (code == EXCEPTION) {
+        exceptions = write_varint(start + j - next_exception, exceptions);
+        *exceptions++ = uint8_t(bases[start + j]);
+        next_exception = start + j + 1;
+        code = 0;
+      }
+      byte |= uint8_t(code << (2 * j));
+    }
+    dest[i] = byte;
+  }
+  return exceptions - dest;
+}
+
+void decode(
+    const uint8_t* cell, size_t cell_size, size_t num_bases, char* dest) {
+  const size_t num_packed = packed_size(num_bases);
+  if (cell_size < num_packed)
+    throw std::runtime_error(
+        "Error decoding sequence; cell of " + std::to_string(cell_size) +
+        " bytes is too small for " + std::to_string(num_bases) + " bases");
+  unpack(cell, num_bases, dest);
+
+  const uint8_t* p = cell + num_packed;
+  const uint8_t* end = cell + cell_size;
+  uint64_t pos = 0;
+  while (p < end) {
+    uint64_t delta;
+    p = read_varint(p, end, &delta);
+    if (p == nullptr || p == end || delta >= num_bases - pos)
+      throw std::runtime_error(
+          "Error decoding sequence; malformed exception list");
+    pos += delta;
+    dest[pos++] = char(*p++);
+  }
+}
+
+void unpack(const uint8_t* packed, size_t num_bases, char* dest) {
+#ifdef TILEDB_FASTQ_X86
+  static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+  if (has_ssse3) {
+    unpack_ssse3(packed, num_bases, dest);
+    return;
+  }
+#endif
+  unpack_scalar(packed, num_bases, dest);
+}
+
+}  // namespace sequence_codec
+}  // namespace fq
+}  // namespace tiledb
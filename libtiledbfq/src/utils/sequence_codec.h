@@ -0,0 +1,91 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_SEQUENCE_CODEC_H
+#define TILEDB_FASTQ_SEQUENCE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tiledb {
+namespace fq {
+namespace sequence_codec {
+
+/**
+ * Packs nucleotide sequences into 2 bits per base (A=0, C=1, G=2, T=3), four
+ * bases per byte starting from the low bits. Any other symbol (N, IUPAC
+ * codes, lowercase bases) is packed as A and recorded as an exception.
+ *
+ * An encoded cell is the packed bases followed by the exceptions, each being
+ * the varint-encoded distance from the previous exception and the symbol
+ * itself. The number of bases is not stored; it is given by the length of
+ * the quality cell.
+ */
+
+/** Returns the number of bytes holding the packed bases. */
+size_t packed_size(size_t num_bases);
+
+/** Returns an upper bound on the size of an encoded cell. */
+size_t max_encoded_size(size_t num_bases);
+
+/**
+ * Encodes a sequence of bases.
+ *
+ * @param bases Bases to encode
+ * @param num_bases Number of bases
+ * @param dest Destination, with room for max_encoded_size() bytes
+ * @return Size of the encoded cell, in bytes
+ */
+size_t encode(const char* bases, size_t num_bases, uint8_t* dest);
+
+/**
+ * Decodes a sequence of bases.
+ *
+ * @param cell Encoded cell
+ * @param cell_size Size of the encoded cell, in bytes
+ * @param num_bases Number of bases in the sequence
+ * @param dest Destination, with room for num_bases chars
+ *
+ * @throws std::runtime_error if the cell is malformed.
+ */
+void decode(
+    const uint8_t* cell, size_t cell_size, size_t num_bases, char* dest);
+
+/**
+ * Unpacks 2-bit packed bases into ACGT characters, ignoring exceptions. Uses
+ * SSSE3 when the CPU supports it.
+ *
+ * @param packed Packed bases
+ * @param num_bases Number of bases to unpack
+ * @param dest Destination, with room for num_bases chars
+ */
+void unpack(const uint8_t* packed, size_t num_bases, char* dest);
+
+}  // namespace sequence_codec
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_SEQUENCE_CODEC_H
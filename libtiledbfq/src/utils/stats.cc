@@ -0,0 +1,157 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <iomanip>
+#include <sstream>
+
+#include "utils/stats.h"
+
+namespace tiledb {
+namespace fq {
+
+Stats::Stats()
+    : start_time_(std::chrono::steady_clock::now())
+    , progress_stop_(false) {
+}
+
+Stats::~Stats() {
+  stop_progress();
+}
+
+Stats::Counter& Stats::counter(const std::string& name) {
+  return get(&counters_, name);
+}
+
+Stats::Counter& Stats::timer(const std::string& name) {
+  return get(&timers_, name);
+}
+
+Stats::Counter& Stats::peak(const std::string& name) {
+  return get(&peaks_, name);
+}
+
+void Stats::update_peak(Counter* peak, uint64_t value) {
+  uint64_t current = peak->load();
+  while (value > current && !peak->compare_exchange_weak(current, value))
+    ;
+}
+
+void Stats::clear() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  counters_.clear();
+  timers_.clear();
+  peaks_.clear();
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+double Stats::elapsed_sec() const {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now() - start_time_)
+      .count();
+}
+
+std::string Stats::to_json() const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  auto print = [&os](const CounterMap& map, double scale) {
+    os << "{";
+    for (auto it = map.begin(); it != map.end(); ++it) {
+      os << (it == map.begin() ? "" : ",") << "\n    \"" << it->first
+         << "\": ";
+      if (scale == 1)
+        os << it->second->load();
+      else
+        os << it->second->load() * scale;
+    }
+    os << (map.empty() ? "}" : "\n  }");
+  };
+  os << "{\n  \"elapsed_sec\": " << elapsed_sec() << ",\n  \"counters\": ";
+  print(counters_, 1);
+  os << ",\n  \"timers_sec\": ";
+  print(timers_, 1e-9);
+  os << ",\n  \"peaks\": ";
+  print(peaks_, 1);
+  os << "\n}\n";
+  return os.str();
+}
+
+void Stats::start_progress(
+    std::ostream* os,
+    const std::string& records,
+    const std::string& bytes,
+    unsigned interval_ms) {
+  stop_progress();
+  Counter* num_records = &counter(records);
+  Counter* num_bytes = &counter(bytes);
+  progress_stop_ = false;
+  progress_thread_ = std::thread([=]() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    const auto interval = std::chrono::milliseconds(interval_ms);
+    while (!progress_cv_.wait_for(
+        lck, interval, [this]() { return progress_stop_; })) {
+      const double sec = elapsed_sec();
+      const double mb = num_bytes->load() / (1024.0 * 1024.0);
+      *os << std::fixed << std::setprecision(1) << "Progress: " << sec
+          << " s, " << num_records->load() << " records ("
+          << uint64_t(num_records->load() / sec) << "/s), " << mb << " MB ("
+          << mb / sec << " MB/s)" << std::endl;
+    }
+  });
+}
+
+void Stats::stop_progress() {
+  if (!progress_thread_.joinable())
+    return;
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    progress_stop_ = true;
+  }
+  progress_cv_.notify_all();
+  progress_thread_.join();
+}
+
+Stats::Counter& Stats::get(CounterMap* map, const std::string& name) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto& counter = (*map)[name];
+  if (counter == nullptr)
+    counter.reset(new Counter(0));
+  return *counter;
+}
+
+ScopedTimer::ScopedTimer(Stats::Counter* timer)
+    : timer_(timer)
+    , start_(std::chrono::steady_clock::now()) {
+}
+
+ScopedTimer::~ScopedTimer() {
+  *timer_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now() - start_)
+                 .count();
+}
+
+}  // namespace fq
+}  // namespace tiledb
@@ -0,0 +1,159 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_STATS_H
+#define TILEDB_FASTQ_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace tiledb {
+namespace fq {
+
+/**
+ * Named counters, stage timers and peaks of an ingestion or export, updated
+ * concurrently by the pipeline stages.
+ *
+ * Looking up a statistic by name takes a lock, so stages look up their
+ * statistics once and update them through the returned references.
+ */
+class Stats {
+ public:
+  typedef std::atomic<uint64_t> Counter;
+
+  /** Constructor. */
+  Stats();
+
+  /** Destructor; stops the progress reports. */
+  ~Stats();
+
+  /** Unimplemented rule-of-5. */
+  Stats(Stats&&) = delete;
+  Stats(const Stats&) = delete;
+  Stats& operator=(Stats&&) = delete;
+  Stats& operator=(const Stats&) = delete;
+
+  /** Returns the named counter, created at 0. */
+  Counter& counter(const std::string& name);
+
+  /** Returns the named timer, counting nanoseconds, created at 0. */
+  Counter& timer(const std::string& name);
+
+  /** Returns the named peak value, created at 0. */
+  Counter& peak(const std::string& name);
+
+  /** Raises a peak to the given value, if higher. */
+  static void update_peak(Counter* peak, uint64_t value);
+
+  /**
+   * Removes all statistics, and restarts the elapsed time. No references to
+   * the statistics may be in use.
+   */
+  void clear();
+
+  /** Returns the seconds elapsed since construction or the last clear. */
+  double elapsed_sec() const;
+
+  /**
+   * Returns the statistics as a JSON object, with the counters, the timers
+   * in seconds and the peaks.
+   */
+  std::string to_json() const;
+
+  /**
+   * Starts printing a progress line periodically, with the given counters
+   * of records and bytes processed.
+   *
+   * @param os Stream to print to
+   * @param records Name of the counter of records
+   * @param bytes Name of the counter of bytes
+   * @param interval_ms Time between two lines
+   */
+  void start_progress(
+      std::ostream* os,
+      const std::string& records,
+      const std::string& bytes,
+      unsigned interval_ms = 5000);
+
+  /** Stops printing progress lines. */
+  void stop_progress();
+
+ private:
+  typedef std::map<std::string, std::unique_ptr<Counter>> CounterMap;
+
+  mutable std::mutex mtx_;
+
+  CounterMap counters_;
+
+  CounterMap timers_;
+
+  CounterMap peaks_;
+
+  std::chrono::steady_clock::time_point start_time_;
+
+  /** Thread printing the progress lines, if running. */
+  std::thread progress_thread_;
+
+  std::condition_variable progress_cv_;
+
+  bool progress_stop_;
+
+  Counter& get(CounterMap* map, const std::string& name);
+};
+
+/** Adds the time from construction to destruction to a timer. */
+class ScopedTimer {
+ public:
+  /** Constructor; starts timing. */
+  explicit ScopedTimer(Stats::Counter* timer);
+
+  /** Destructor; adds the elapsed time to the timer. */
+  ~ScopedTimer();
+
+  /** Unimplemented rule-of-5. */
+  ScopedTimer(ScopedTimer&&) = delete;
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(ScopedTimer&&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  Stats::Counter* timer_;
+
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_STATS_H
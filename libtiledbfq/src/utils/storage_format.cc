@@ -0,0 +1,217 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdexcept>
+
+#include "utils/storage_format.h"
+
+namespace tiledb {
+namespace fq {
+
+namespace {
+const std::string SEQUENCE_ENCODING_KEY = "sequence_encoding";
+const std::string READ_LENGTH_KEY = "fixed_read_length";
+const std::string TILE_EXTENT_KEY = "tile_extent";
+const std::string QUALITY_ENCODING_KEY = "quality_encoding";
+const std::string QUALITY_BINS_KEY = "quality_bins";
+const std::string HEADER_INDEX_KEY = "header_index";
+const std::string HEADER_TEMPLATE_KEY = "header_template";
+const std::string DESCRIPTION_ENCODING_KEY = "description_encoding";
+const std::string PAIRED_KEY = "paired";
+const std::string COMPRESSION_KEY = "compression";
+const std::string COMPRESSION_FILTERS_KEY = "compression_filters";
+
+void put_string(
+    tiledb::Array* array, const std::string& key, const std::string& value) {
+  array->put_metadata(key, TILEDB_CHAR, (uint32_t)value.size(), value.data());
+}
+
+/** Returns false if the array has no such metadata. */
+bool get_string(
+    tiledb::Array* array, const std::string& key, std::string* value) {
+  tiledb_datatype_t type;
+  uint32_t num;
+  const void* data;
+  array->get_metadata(key, &type, &num, &data);
+  if (data == nullptr)
+    return false;
+  if (type != TILEDB_CHAR)
+    throw std::runtime_error(
+        "Error reading array metadata; invalid type of '" + key + "'");
+  value->assign((const char*)data, num);
+  return true;
+}
+
+/**
+ * Returns a string metadata item.
+ *
+ * @throws std::runtime_error if the array has no such metadata.
+ */
+std::string get_required_string(
+    tiledb::Array* array, const std::string& key) {
+  std::string value;
+  if (!get_string(array, key, &value))
+    throw std::runtime_error(
+        "Error reading array metadata; missing '" + key + "'");
+  return value;
+}
+
+/**
+ * Returns a metadata item holding a single value of the given type.
+ *
+ * @throws std::runtime_error if the array has no such metadata, or it is not
+ *    a single value of that type.
+ */
+template <typename T>
+T get_value(
+    tiledb::Array* array, const std::string& key, tiledb_datatype_t type) {
+  tiledb_datatype_t value_type;
+  uint32_t num;
+  const void* value;
+  array->get_metadata(key, &value_type, &num, &value);
+  if (value == nullptr || value_type != type || num != 1)
+    throw std::runtime_error(
+        "Error reading array metadata; missing or invalid '" + key + "'");
+  return *(const T*)value;
+}
+
+std::string to_string(SequenceEncoding encoding) {
+  switch (encoding) {
+    case SequenceEncoding::Raw:
+      return "raw";
+    case SequenceEncoding::TwoBit:
+      return "2bit";
+  }
+  throw std::runtime_error("Unknown sequence encoding");
+}
+
+uint64_t schema_tile_extent(tiledb::Array* array) {
+  return array->schema().domain().dimension("d1").tile_extent<uint64_t>();
+}
+
+std::string to_string(DescriptionEncoding encoding) {
+  switch (encoding) {
+    case DescriptionEncoding::Raw:
+      return "raw";
+    case DescriptionEncoding::Kinds:
+      return "kinds";
+  }
+  throw std::runtime_error("Unknown description encoding");
+}
+}  // namespace
+
+void StorageFormat::put_metadata(tiledb::Array* array) const {
+  put_string(array, SEQUENCE_ENCODING_KEY, to_string(sequence_encoding));
+  array->put_metadata(READ_LENGTH_KEY, TILEDB_UINT32, 1, &fixed_read_length);
+  array->put_metadata(TILE_EXTENT_KEY, TILEDB_UINT64, 1, &tile_extent);
+  if (quality_bin_table.empty()) {
+    put_string(array, QUALITY_ENCODING_KEY, "lossless");
+  } else {
+    put_string(array, QUALITY_ENCODING_KEY, "binned");
+    put_string(
+        array, QUALITY_BINS_KEY, quality_bins::to_string(quality_bin_table));
+  }
+  if (!header_template.empty())
+    put_string(
+        array, HEADER_TEMPLATE_KEY, header_tokens::to_string(header_template));
+  put_string(
+      array, DESCRIPTION_ENCODING_KEY, to_string(description_encoding));
+  const uint8_t has_index = header_index ? 1 : 0;
+  array->put_metadata(HEADER_INDEX_KEY, TILEDB_UINT8, 1, &has_index);
+  const uint8_t is_paired = paired ? 1 : 0;
+  array->put_metadata(PAIRED_KEY, TILEDB_UINT8, 1, &is_paired);
+  put_string(array, COMPRESSION_KEY, filters.preset);
+  put_string(array, COMPRESSION_FILTERS_KEY, compression::to_string(filters));
+}
+
+void StorageFormat::get_metadata(tiledb::Array* array) {
+  std::string encoding;
+  if (!get_string(array, SEQUENCE_ENCODING_KEY, &encoding)) {
+    // Arrays written before the format was recorded.
+    sequence_encoding = SequenceEncoding::Raw;
+    quality_bin_table.clear();
+    header_template.clear();
+    description_encoding = DescriptionEncoding::Raw;
+    const unsigned cell_val_num =
+        array->schema().attribute("quality").cell_val_num();
+    fixed_read_length = cell_val_num == TILEDB_VAR_NUM ? 0 : cell_val_num;
+    tile_extent = schema_tile_extent(array);
+    header_index = false;
+    paired = false;
+    filters = compression::preset("bzip2");
+    return;
+  }
+
+  if (encoding == to_string(SequenceEncoding::Raw))
+    sequence_encoding = SequenceEncoding::Raw;
+  else if (encoding == to_string(SequenceEncoding::TwoBit))
+    sequence_encoding = SequenceEncoding::TwoBit;
+  else
+    throw std::runtime_error(
+        "Error reading array metadata; unknown sequence encoding '" +
+        encoding + "'");
+
+  fixed_read_length =
+      get_value<uint32_t>(array, READ_LENGTH_KEY, TILEDB_UINT32);
+  tile_extent = get_value<uint64_t>(array, TILE_EXTENT_KEY, TILEDB_UINT64);
+
+  quality_bin_table.clear();
+  encoding = get_required_string(array, QUALITY_ENCODING_KEY);
+  if (encoding == "binned")
+    quality_bin_table =
+        quality_bins::parse(get_required_string(array, QUALITY_BINS_KEY));
+  else if (encoding != "lossless")
+    throw std::runtime_error(
+        "Error reading array metadata; invalid quality encoding '" + encoding +
+        "'");
+
+  // Headers are only tokenized when a template was inferred.
+  std::string spec;
+  header_template.clear();
+  if (get_string(array, HEADER_TEMPLATE_KEY, &spec))
+    header_template = header_tokens::parse(spec);
+
+  encoding = get_required_string(array, DESCRIPTION_ENCODING_KEY);
+  if (encoding == to_string(DescriptionEncoding::Raw))
+    description_encoding = DescriptionEncoding::Raw;
+  else if (encoding == to_string(DescriptionEncoding::Kinds))
+    description_encoding = DescriptionEncoding::Kinds;
+  else
+    throw std::runtime_error(
+        "Error reading array metadata; unknown description encoding '" +
+        encoding + "'");
+
+  header_index = get_value<uint8_t>(array, HEADER_INDEX_KEY, TILEDB_UINT8) != 0;
+  paired = get_value<uint8_t>(array, PAIRED_KEY, TILEDB_UINT8) != 0;
+
+  filters = compression::Config();
+  filters.preset = get_required_string(array, COMPRESSION_KEY);
+  compression::apply_overrides(
+      get_required_string(array, COMPRESSION_FILTERS_KEY), &filters);
+}
+
+}  // namespace fq
+}  // namespace tiledb
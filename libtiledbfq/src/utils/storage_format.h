@@ -0,0 +1,120 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_STORAGE_FORMAT_H
+#define TILEDB_FASTQ_STORAGE_FORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <tiledb/tiledb>
+
+#include "utils/compression.h"
+#include "utils/header_tokens.h"
+#include "utils/quality_bins.h"
+
+namespace tiledb {
+namespace fq {
+
+/** Encoding of the sequence attribute. */
+enum class SequenceEncoding {
+  /** One char per base. */
+  Raw,
+  /** 2-bit packed bases with exceptions, see sequence_codec. */
+  TwoBit
+};
+
+/** Encoding of the descriptions. */
+enum class DescriptionEncoding {
+  /** One var-length cell per record, with "-" for empty descriptions. */
+  Raw,
+  /**
+   * The kind of each description, with the explicit descriptions in a side
+   * array, see descriptions.
+   */
+  Kinds
+};
+
+/**
+ * How the FastQ records are stored in an array. Recorded in the array
+ * metadata, so that readers can decode the attributes.
+ */
+struct StorageFormat {
+  /** Length of every read, or 0 if the reads are stored as var-length. */
+  uint32_t fixed_read_length = 0;
+
+  /** Number of records per tile. */
+  uint64_t tile_extent = 100000;
+
+  SequenceEncoding sequence_encoding = SequenceEncoding::TwoBit;
+
+  /**
+   * Bins of the quality scores, whose indices are stored instead of the
+   * scores. Empty if the scores are stored losslessly.
+   */
+  std::vector<quality_bins::Bin> quality_bin_table;
+
+  /**
+   * Template of the headers stored as fields, see header_tokens. Empty if
+   * the headers are stored verbatim.
+   */
+  std::vector<header_tokens::Field> header_template;
+
+  DescriptionEncoding description_encoding = DescriptionEncoding::Kinds;
+
+  /** True if the array has a header index, see header_index. */
+  bool header_index = false;
+
+  /**
+   * True if the records are paired-end reads, stored with the two mates of
+   * each pair as consecutive records 2i and 2i + 1.
+   */
+  bool paired = false;
+
+  /**
+   * Filter pipelines the array was created with. Arrays without format
+   * metadata use the "bzip2" preset.
+   */
+  compression::Config filters;
+
+  /** Writes the format to the metadata of an array open for writing. */
+  void put_metadata(tiledb::Array* array) const;
+
+  /**
+   * Reads the format from the metadata of an array open for reading. Arrays
+   * without format metadata store raw sequences and lossless qualities.
+   *
+   * @throws std::runtime_error if the array has format metadata but some of
+   *    it is missing or invalid.
+   */
+  void get_metadata(tiledb::Array* array);
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_STORAGE_FORMAT_H
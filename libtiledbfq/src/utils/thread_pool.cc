@@ -0,0 +1,99 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include "utils/thread_pool.h"
+
+namespace tiledb {
+namespace fq {
+
+ThreadPool::ThreadPool(unsigned num_threads)
+    : stop_(false) {
+  for (unsigned i = 0; i < std::max(num_threads, 1u); i++)
+    threads_.emplace_back([this]() { worker(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& t : threads_)
+    t.join();
+}
+
+std::future<void> ThreadPool::execute(std::function<void()> task) {
+  // std::function requires a copyable target, so share the packaged task.
+  auto packaged =
+      std::make_shared<std::packaged_task<void()>>(std::move(task));
+  std::future<void> result = packaged->get_future();
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    tasks_.push_back([packaged]() { (*packaged)(); });
+  }
+  cv_.notify_one();
+  return result;
+}
+
+unsigned ThreadPool::num_threads() const {
+  return static_cast<unsigned>(threads_.size());
+}
+
+void ThreadPool::wait_all(std::vector<std::future<void>>* futures) {
+  std::exception_ptr error;
+  for (auto& f : *futures) {
+    try {
+      f.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  futures->clear();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void ThreadPool::worker() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lck(mtx_);
+      cv_.wait(lck, [this]() { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty())
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace fq
+}  // namespace tiledb
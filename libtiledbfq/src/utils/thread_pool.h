@@ -0,0 +1,93 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_THREAD_POOL_H
+#define TILEDB_FASTQ_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiledb {
+namespace fq {
+
+/**
+ * A fixed-size pool of worker threads executing tasks in FIFO order.
+ */
+class ThreadPool {
+ public:
+  /** Constructor; starts the given number of worker threads. */
+  explicit ThreadPool(unsigned num_threads);
+
+  /** Destructor; finishes the queued tasks and joins the worker threads. */
+  ~ThreadPool();
+
+  /** Unimplemented rule-of-5. */
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Queues a task for execution.
+   *
+   * @param task Task to execute
+   * @return A future that becomes ready when the task has run, rethrowing any
+   *    exception thrown by the task.
+   */
+  std::future<void> execute(std::function<void()> task);
+
+  /** Returns the number of worker threads. */
+  unsigned num_threads() const;
+
+  /**
+   * Waits for all of the given futures, and rethrows the first exception
+   * thrown by any of their tasks.
+   */
+  static void wait_all(std::vector<std::future<void>>* futures);
+
+ private:
+  std::vector<std::thread> threads_;
+
+  std::deque<std::function<void()>> tasks_;
+
+  std::mutex mtx_;
+
+  std::condition_variable cv_;
+
+  bool stop_;
+
+  void worker();
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_THREAD_POOL_H
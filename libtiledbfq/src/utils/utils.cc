@@ -195,6 +195,23 @@ void upload_file(
   os.write(buffer.data<char>(), file_bytes);
 }
 
+void write_file(
+    const tiledb::VFS& vfs, const std::string& uri, const std::string& text) {
+  if (vfs.is_file(uri))
+    vfs.remove_file(uri);
+  tiledb::VFS::filebuf sbuf(vfs);
+  sbuf.open(uri, std::ios::out);
+  std::ostream os(&sbuf);
+  if (!os.good() || os.fail() || os.bad()) {
+    const char* err_c_str = strerror(errno);
+    throw std::runtime_error(
+        "Error writing file '" + uri + "'; " + std::string(err_c_str));
+  }
+  os.write(text.data(), text.size());
+  if (!os)
+    throw std::runtime_error("Error writing file '" + uri + "'");
+}
+
 void append_from_file(const std::string& uri, std::vector<std::string>* lines) {
   tiledb::Context ctx;
   tiledb::VFS vfs(ctx);
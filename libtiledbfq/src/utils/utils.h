@@ -281,6 +281,14 @@ void upload_file(
     const std::string& dest_uri,
     Buffer& buffer);
 
+/**
+ * Writes the given text to a file, replacing any existing file.
+ *
+ * @throws std::runtime_error if an error occurred during writing.
+ */
+void write_file(
+    const tiledb::VFS& vfs, const std::string& uri, const std::string& text);
+
 /**
  * Buffers the contents of the given URI into memory (using the given VFS
  * instance) and makes the given callback for each textual line in the file.
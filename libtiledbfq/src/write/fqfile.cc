@@ -24,178 +24,638 @@
  * THE SOFTWARE.
  */
 
-#include <zlib.h>
-
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#include "utils/bgzf.h"
+#include "utils/scan.h"
+#include "utils/utils.h"
 #include "write/fqfile.h"
 
 namespace tiledb {
 namespace fq {
 
+namespace {
+/**
+ * Sets the local path named by a URI, if it is a plain path or a file://
+ * URI.
+ *
+ * @return False if the URI names a remote object
+ */
+bool local_path(const std::string& uri, std::string* path) {
+  if (utils::starts_with(uri, "file://"))
+    *path = uri.substr(7);
+  else if (uri.find("://") == std::string::npos)
+    *path = uri;
+  else
+    return false;
+  return true;
+}
+}  // namespace
+
 FQFile::FQFile()
-    : file_size_(0)
-    , buffer_offset_(0) {
+    : file_buffer_bytes_(1024 * 1024)
+    , window_bytes_(64 * 1024 * 1024)
+    , file_size_(0)
+    , file_offset_(0)
+    , stream_(false)
+    , file_eof_(false)
+    , file_buffer_offset_(0)
+    , bgzf_(true)
+    , plain_(false)
+    , map_(nullptr)
+    , map_size_(0)
+    , buffer_offset_(0)
+    , records_end_(0)
+    , strm_init_(false)
+    , inflate_done_(false) {
+  std::memset(&strm_, 0, sizeof(strm_));
+}
+
+FQFile::~FQFile() {
+  end_inflate();
+  unmap_file();
 }
 
 void FQFile::open(const std::string& uri) {
   init_tiledb();
-  if (!vfs_->is_file(uri))
+  stream_ = is_stream(uri);
+  if (!stream_ && !vfs_->is_file(uri))
     throw std::runtime_error(
         "Error opening FastQ file '" + uri + "'; file does not exist.");
 
   uri_ = uri;
-  file_size_ = vfs_->file_size(uri);
+  file_size_ = stream_ ? 0 : vfs_->file_size(uri);
+  file_offset_ = 0;
+  file_eof_ = false;
+  file_buffer_.clear();
+  file_buffer_offset_ = 0;
+  buffer_.clear();
   buffer_offset_ = 0;
+  records_end_ = 0;
+
+  // Uncompressed local files are read in place from a mapping, without the
+  // VFS read buffer or zlib.
+  is_.reset();
+  filebuf_.reset();
+  end_inflate();
+  unmap_file();
+  if (!stream_ && map_file()) {
+    plain_ = true;
+    bgzf_ = false;
+    inflate_done_ = false;
+    return;
+  }
+
+  // Streams bypass the VFS, which needs to know the size of the file.
+  if (stream_) {
+    const std::string path = uri == "-" ? "/dev/stdin" : uri;
+    is_.reset(new std::ifstream(
+        utils::starts_with(path, "file://") ? path.substr(7) : path,
+        std::ios::in | std::ios::binary));
+  } else {
+    filebuf_.reset(new VFS::filebuf(*vfs_));
+    filebuf_->open(uri_, std::ios::in);
+    is_.reset(new std::istream(filebuf_.get()));
+  }
+  if (!is_->good() || is_->fail() || is_->bad()) {
+    const char* err_c_str = strerror(errno);
+    throw std::runtime_error(
+        "Cannot open FastQ file '" + uri_ + "'; " + std::string(err_c_str));
+  }
+
+  // Input without the gzip magic bytes is taken as uncompressed FastQ, and
+  // skips zlib.
+  read_file_buffer();
+  const uint8_t* magic = file_buffer_.data<uint8_t>();
+  plain_ = file_buffer_.size() < 2 || magic[0] != 0x1f || magic[1] != 0x8b;
+  inflate_done_ = file_buffer_.size() == 0 && file_eof_;
+  if (plain_) {
+    bgzf_ = false;
+    return;
+  }
 
-  // TODO: remove:
-  read_fq_chunk();
+  // The buffer holds at least two blocks, so a gzip file whose first block is
+  // not BGZF is inflated as a gzip stream.
+  init_inflate();
+  size_t block_size, data_size;
+  bgzf_ = bgzf::read_block(
+      magic, file_buffer_.size(), &block_size, &data_size);
+  if (!bgzf_) {
+    strm_.next_in = file_buffer_.data<unsigned char>();
+    strm_.avail_in = (uInt)file_buffer_.size();
+    file_buffer_offset_ = file_buffer_.size();
+  }
 }
 
-bool FQFile::next_record(FQFile::FQRecord* record) {
-  if (buffer_offset_ >= buffer_.size())
+bool FQFile::is_stream(const std::string& uri) {
+  if (uri == "-")
+    return true;
+
+  // Only local paths can name streams.
+  std::string path;
+  if (!local_path(uri, &path))
     return false;
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && !S_ISREG(st.st_mode) &&
+         !S_ISDIR(st.st_mode);
+}
 
+void FQFile::set_memory_budget(unsigned memory_budget_mb) {
+  set_memory_budget_bytes(uint64_t(memory_budget_mb) * 1024 * 1024);
+}
+
+void FQFile::set_memory_budget_bytes(uint64_t memory_budget_bytes) {
+  // Most of the budget goes to the decompressed window; the compressed read
+  // buffer only needs to be big enough to keep zlib busy.
+  file_buffer_bytes_ = std::max<size_t>(
+      4096, std::min<size_t>(memory_budget_bytes / 8, 8 * 1024 * 1024));
+  window_bytes_ = std::max<size_t>(
+      4096,
+      memory_budget_bytes > file_buffer_bytes_ ?
+          memory_budget_bytes - file_buffer_bytes_ :
+          0);
+}
+
+void FQFile::set_num_threads(unsigned num_threads) {
+  if (num_threads > 1)
+    pool_.reset(new ThreadPool(num_threads));
+  else
+    pool_.reset();
+}
+
+uint64_t FQFile::num_bytes_read() const {
+  return file_offset_;
+}
+
+bool FQFile::is_bgzf() const {
+  return bgzf_;
+}
+
+bool FQFile::is_mapped() const {
+  return map_ != nullptr;
+}
+
+bool FQFile::next_record(FQFile::FQRecord* record) {
   if (record == nullptr)
     throw std::runtime_error(
         "Error getting next FQ record; output parameter is null");
 
-  parse_record(record);
+  if (buffer_offset_ >= records_end_ && !read_fq_chunk())
+    return false;
+
+  const char* begin = buffer_.data<char>();
+  const char* end =
+      parse_record(begin + buffer_offset_, begin + records_end_, record);
+  buffer_offset_ = end - begin;
 
   return true;
 }
 
-void FQFile::parse_record(FQFile::FQRecord* record) {
-  size_t offset = buffer_offset_;
-  if (buffer_.value<char>(offset) != '@')
+bool FQFile::next_chunk(Buffer* chunk) {
+  if (chunk == nullptr)
+    throw std::runtime_error(
+        "Error getting next FQ chunk; output parameter is null");
+
+  if (buffer_offset_ >= records_end_ && !read_fq_chunk())
+    return false;
+
+  // Windows of a mapped file are handed out as they are, without a copy.
+  if (map_ != nullptr) {
+    chunk->set_view(
+        buffer_.data<char>() + buffer_offset_, records_end_ - buffer_offset_);
+    buffer_offset_ = 0;
+    records_end_ = 0;
+    return true;
+  }
+
+  // Swap the window out, and copy the trailing partial record back in.
+  chunk->clear();
+  chunk->swap(buffer_);
+  buffer_.append(
+      chunk->data<char>() + records_end_, chunk->size() - records_end_);
+  if (buffer_offset_ > 0)
+    std::memmove(
+        chunk->data<char>(),
+        chunk->data<char>() + buffer_offset_,
+        records_end_ - buffer_offset_);
+  chunk->resize(records_end_ - buffer_offset_);
+
+  buffer_offset_ = 0;
+  records_end_ = 0;
+
+  return true;
+}
+
+void FQFile::release_chunk(const Buffer& chunk) const {
+  const char* begin = chunk.data<char>();
+  if (map_ == nullptr || !chunk.is_view() || begin < map_ ||
+      begin >= map_ + map_size_)
+    return;
+
+  // The pages at either end may be shared with the neighbouring chunks. The
+  // mapping is private and read-only, so a page released too early is only
+  // read again from the file.
+  const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+  const size_t offset = begin - map_;
+  const size_t release_begin = offset - offset % page_size;
+  madvise(
+      const_cast<char*>(map_) + release_begin,
+      offset + chunk.size() - release_begin,
+      MADV_DONTNEED);
+}
+
+const char* FQFile::parse_record(
+    const char* begin, const char* end, FQFile::FQRecord* record) {
+  FQRecordView view;
+  const char* p = parse_record_view(begin, end, &view);
+  record->header.assign(view.header.data, view.header.size);
+  record->sequence.assign(view.sequence.data, view.sequence.size);
+  record->description.assign(view.description.data, view.description.size);
+  record->qualities.resize(view.quality.size);
+  parse_quality_string(view.quality, record->qualities.data());
+  return p;
+}
+
+const char* FQFile::parse_record_view(
+    const char* begin, const char* end, FQFile::FQRecordView* record) {
+  if (begin >= end || *begin != '@')
     throw std::runtime_error("FastQ parse error; expected '@' to begin record");
-  offset += 1;
 
-  record->header.clear();
-  copy_to_delim(buffer_.data<char>() + offset, '\n', &record->header);
-  offset += record->header.size() + 1;
+  // The last record may be missing its trailing newline.
+  const char* line_ends[4];
+  const size_t num_found = scan::find_newlines(begin, end, 4, line_ends);
+  for (size_t i = num_found; i < 4; i++)
+    line_ends[i] = end;
+  auto next_line = [end](const char* line_end) {
+    return line_end < end ? line_end + 1 : end;
+  };
 
-  record->sequence.clear();
-  copy_to_delim(buffer_.data<char>() + offset, '\n', &record->sequence);
-  offset += record->sequence.size() + 1;
+  record->header = {begin + 1, size_t(line_ends[0] - begin - 1)};
 
-  if (*(buffer_.data<char>() + offset) != '+')
+  const char* p = next_line(line_ends[0]);
+  record->sequence = {p, size_t(line_ends[1] - p)};
+
+  p = next_line(line_ends[1]);
+  if (p >= end || *p != '+')
     throw std::runtime_error("FastQ parse error; expected '+' character");
-  offset += 1;
-  record->description.clear();
-  copy_to_delim(buffer_.data<char>() + offset, '\n', &record->description);
-  offset += record->description.size() + 1;
+  record->description = {p + 1, size_t(line_ends[2] - p - 1)};
 
-  std::string quality_string;
-  copy_to_delim(buffer_.data<char>() + offset, '\n', &quality_string);
-  offset += quality_string.size() + 1;
+  p = next_line(line_ends[2]);
+  record->quality = {p, size_t(line_ends[3] - p)};
+  if (record->quality.size != record->sequence.size)
+    throw std::runtime_error(
+        "FastQ parse error; sequence and quality lengths differ in record '" +
+        record->header.str() + "'");
 
-  record->qualities.clear();
-  parse_quality_string(quality_string, &record->qualities);
+  return next_line(line_ends[3]);
+}
 
-  buffer_offset_ = offset;
+void FQFile::parse_quality_string(const Span& quality, uint8_t* result) {
+  if (!scan::quality_scores(quality.data, quality.size, result))
+    throw std::runtime_error(
+        "FastQ parse error; invalid char in quality string " + quality.str());
 }
 
-void FQFile::parse_quality_string(
-    const std::string& quality_string, std::vector<uint8_t>* result) const {
-  for (char c : quality_string) {
-    if (c < '!' || c > '~')
-      throw std::runtime_error(
-          "FastQ parse error; invalid char '" + std::to_string(c) +
-          "' in quality string " + quality_string);
-    uint8_t q = (uint8_t)(c - '!');
-    result->push_back(q);
+bool FQFile::read_fq_chunk() {
+  if (map_ != nullptr)
+    return map_window();
+
+  // Carry the trailing partial record over to the start of the next window.
+  const size_t carry = buffer_.size() - records_end_;
+  if (carry > 0 && records_end_ > 0)
+    std::memmove(
+        buffer_.data<char>(), buffer_.data<char>() + records_end_, carry);
+  buffer_.resize(carry);
+  buffer_offset_ = 0;
+  records_end_ = 0;
+
+  while (true) {
+    buffer_.reserve(window_bytes_);
+    while (buffer_.size() < window_bytes_ && inflate_more())
+      ;
+
+    // The window ends on the last complete record it holds.
+    records_end_ = find_records_end(0);
+    if (records_end_ > 0)
+      return true;
+
+    if (inflate_done_) {
+      // The last record in the file may be missing its trailing newline.
+      const char* data = buffer_.data<char>();
+      bool blank = true;
+      for (size_t i = 0; i < buffer_.size() && blank; i++)
+        blank = std::isspace(data[i]) != 0;
+      if (blank) {
+        buffer_.clear();
+        return false;
+      }
+      records_end_ = buffer_.size();
+      return true;
+    }
+
+    // A single record does not fit in the window; grow it.
+    window_bytes_ *= 2;
   }
 }
 
-void FQFile::copy_to_delim(
-    const char* src, char delim, std::string* dest) const {
-  while (*src != delim && *src != '\0')
-    dest->push_back(*src++);
+bool FQFile::map_window() {
+  // The window ends on the last complete record in the next window_bytes_ of
+  // the mapping; the partial record after it starts the next window.
+  buffer_offset_ = 0;
+  records_end_ = 0;
+  const char* begin = map_ + file_offset_;
+  while (true) {
+    const size_t size = std::min(map_size_ - file_offset_, window_bytes_);
+    const bool last = file_offset_ + size == map_size_;
+    size_t records_size =
+        scan::find_groups_end(begin, begin + size, 4) - begin;
+    if (records_size == 0 && last) {
+      // The last record in the file may be missing its trailing newline.
+      bool blank = true;
+      for (size_t i = 0; i < size && blank; i++)
+        blank = std::isspace(begin[i]) != 0;
+      if (blank) {
+        buffer_.clear();
+        file_offset_ = map_size_;
+        inflate_done_ = true;
+        return false;
+      }
+      records_size = size;
+    }
+
+    if (records_size > 0) {
+      buffer_.set_view(begin, records_size);
+      records_end_ = records_size;
+      file_offset_ += records_size;
+      return true;
+    }
+
+    // A single record does not fit in the window; grow it.
+    window_bytes_ *= 2;
+  }
 }
 
-bool FQFile::read_fq_chunk() {
-  // TODO: read in a chunk that's guaranteed to end on a record boundary.
-  //   Currently just buffering the whole file.
-  VFS::filebuf filebuf(*vfs_);
-  filebuf.open(uri_, std::ios::in);
-  std::istream is(&filebuf);
-  if (!is.good() || is.fail() || is.bad()) {
-    const char* err_c_str = strerror(errno);
-    throw std::runtime_error(
-        "Cannot read FastQ chunk from '" + uri_ + "'; " +
-        std::string(err_c_str));
-  }
+size_t FQFile::find_records_end(size_t start) const {
+  const char* data = buffer_.data<char>();
+  return scan::find_groups_end(data + start, data + buffer_.size(), 4) - data;
+}
 
-  buffer_.clear();
-  buffer_.resize(file_size_);
+bool FQFile::inflate_more() {
+  if (inflate_done_)
+    return false;
 
-  is.read(buffer_.data<char>(), file_size_);
-  if (is.bad() || static_cast<uint64_t>(is.gcount()) != file_size_) {
-    const char* err_c_str = strerror(errno);
+  if (plain_)
+    return copy_plain();
+  if (bgzf_)
+    return inflate_bgzf();
+
+  // Read the next piece of compressed input once zlib has consumed the last.
+  auto read_input = [this]() {
+    file_buffer_offset_ = file_buffer_.size();
+    read_file_buffer();
+    strm_.next_in = file_buffer_.data<unsigned char>();
+    strm_.avail_in = (uInt)file_buffer_.size();
+  };
+  if (strm_.avail_in == 0 && !file_eof_)
+    read_input();
+
+  const size_t avail_out = window_bytes_ - buffer_.size();
+  strm_.next_out = buffer_.data<unsigned char>() + buffer_.size();
+  strm_.avail_out = (uInt)avail_out;
+
+  int ret = inflate(&strm_, Z_NO_FLUSH);
+  switch (ret) {
+    case Z_OK:
+    case Z_BUF_ERROR:
+    case Z_STREAM_END:
+      // OK or recoverable errors.
+      break;
+    default:
+      std::string msg(strm_.msg != nullptr ? strm_.msg : "unknown error");
+      end_inflate();
+      throw std::runtime_error(
+          "Error decompressing; zlib inflate failed: " + msg);
+  }
+
+  buffer_.resize(buffer_.size() + (avail_out - strm_.avail_out));
+
+  // The end of a stream is only known once a read comes up short; read on to
+  // see whether another gzip member follows.
+  if (ret == Z_STREAM_END && strm_.avail_in == 0 && !file_eof_)
+    read_input();
+  const bool input_done = strm_.avail_in == 0 && file_eof_;
+  if (ret == Z_STREAM_END) {
+    if (input_done) {
+      inflate_done_ = true;
+      end_inflate();
+    } else if (inflateReset(&strm_) != Z_OK) {
+      // More input follows, i.e. concatenated gzip members.
+      throw std::runtime_error(
+          "Error decompressing; zlib stream reset failed.");
+    }
+  } else if (ret == Z_BUF_ERROR && input_done) {
     throw std::runtime_error(
-        "Error reading from file '" + uri_ + "'; " + std::string(err_c_str));
+        "Error decompressing '" + uri_ +
+        "'; unexpected end of compressed data.");
   }
 
-  // TODO encapsulate decompression; also go chunk by chunk.
-  // Allocate deflate state
-  z_stream strm;
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  strm.avail_in = 0;
-  strm.next_in = Z_NULL;
+  return true;
+}
 
-  const int window_bits = 32;  // 32 = auto detect header
-  if (inflateInit2(&strm, window_bits) != Z_OK)
-    throw std::runtime_error("Error decompressing; zlib stream init failed.");
+bool FQFile::inflate_bgzf() {
+  // Make sure a whole block is buffered, unless at the end of the file.
+  if (file_buffer_.size() - file_buffer_offset_ < bgzf::MAX_BLOCK_SIZE &&
+      !file_eof_)
+    read_file_buffer();
+
+  // Find the buffered blocks whose data fits in the rest of the window.
+  struct Block {
+    const uint8_t* data;
+    size_t size;
+    size_t data_size;
+    size_t dest_offset;
+  };
+  std::vector<Block> blocks;
+  const size_t start_offset = file_buffer_offset_;
+  size_t dest_offset = buffer_.size();
+  while (file_buffer_offset_ < file_buffer_.size()) {
+    const uint8_t* p = file_buffer_.data<uint8_t>() + file_buffer_offset_;
+    const size_t avail = file_buffer_.size() - file_buffer_offset_;
+    size_t block_size, data_size;
+    if (!bgzf::read_block(p, avail, &block_size, &data_size)) {
+      // Blocks cut off at the end of the buffer are read by the next call.
+      if (file_buffer_offset_ > start_offset)
+        break;
+
+      // The rest of the input is not BGZF; inflate it as a gzip stream.
+      bgzf_ = false;
+      strm_.next_in = const_cast<uint8_t*>(p);
+      strm_.avail_in = (uInt)avail;
+      file_buffer_offset_ = file_buffer_.size();
+      return true;
+    }
+
+    if (dest_offset + data_size > window_bytes_)
+      break;
+    if (data_size > 0)
+      blocks.push_back({p, block_size, data_size, dest_offset});
+    dest_offset += data_size;
+    file_buffer_offset_ += block_size;
+  }
 
-  Buffer output;
-  output.reserve(static_cast<size_t>(1.5f * buffer_.size()));
-
-  // Decompress
-  const size_t chunk_size = 10 * 1024 * 1024;
-  Buffer chunk_buff;
-  chunk_buff.resize(chunk_size);
-
-  strm.next_in = buffer_.data<unsigned char>();
-  strm.next_out = chunk_buff.data<unsigned char>();
-  strm.avail_in = (uInt)buffer_.size();
-  strm.avail_out = chunk_size;
-
-  // Repeat until the input stream is exhausted.
-  int ret;
-  do {
-    do {
-      strm.next_out = chunk_buff.data<unsigned char>();
-      strm.avail_out = chunk_size;
-
-      ret = inflate(&strm, Z_NO_FLUSH);
-      switch (ret) {
-        case Z_OK:
-        case Z_BUF_ERROR:
-        case Z_STREAM_END:
-          // OK or recoverable errors.
-          break;
-        default:
-          std::string msg(strm.msg);
-          inflateEnd(&strm);
-          throw std::runtime_error(
-              "Error decompressing; zlib inflate failed: " + msg);
+  // Inflate the blocks straight to their place in the window, in parallel.
+  buffer_.resize(dest_offset);
+  uint8_t* dest = buffer_.data<uint8_t>();
+  auto inflate_blocks = [&blocks, dest](size_t begin, size_t end) {
+    z_stream strm;
+    std::memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, -15) != Z_OK)
+      throw std::runtime_error("Error decompressing; zlib stream init failed.");
+    try {
+      for (size_t i = begin; i < end; i++) {
+        const Block& b = blocks[i];
+        bgzf::inflate_block(
+            &strm, b.data, b.size, dest + b.dest_offset, b.data_size);
       }
+    } catch (...) {
+      inflateEnd(&strm);
+      throw;
+    }
+    inflateEnd(&strm);
+  };
+
+  const size_t num_tasks =
+      pool_ == nullptr ? 1 :
+                         std::min<size_t>(blocks.size(), pool_->num_threads());
+  if (num_tasks <= 1) {
+    inflate_blocks(0, blocks.size());
+  } else {
+    std::vector<std::future<void>> tasks;
+    for (size_t t = 0; t < num_tasks; t++) {
+      const size_t begin = t * blocks.size() / num_tasks;
+      const size_t end = (t + 1) * blocks.size() / num_tasks;
+      tasks.push_back(pool_->execute(
+          [&inflate_blocks, begin, end]() { inflate_blocks(begin, end); }));
+    }
+    ThreadPool::wait_all(&tasks);
+  }
 
-      size_t res_bytes = chunk_size - strm.avail_out;
-      output.append(chunk_buff.data<void>(), res_bytes);
-    } while (strm.avail_out == 0);
-  } while (ret != Z_STREAM_END);
+  if (file_buffer_offset_ >= file_buffer_.size() && file_eof_) {
+    inflate_done_ = true;
+    end_inflate();
+  }
 
-  if (inflateEnd(&strm) != Z_OK)
-    throw std::runtime_error("Error decompressing; zlib stream deinit failed.");
+  return file_buffer_offset_ > start_offset;
+}
 
-  output.swap(buffer_);
-  buffer_offset_ = 0;
+bool FQFile::copy_plain() {
+  if (file_buffer_offset_ >= file_buffer_.size() && !file_eof_)
+    read_file_buffer();
 
+  const size_t size = std::min(
+      file_buffer_.size() - file_buffer_offset_,
+      window_bytes_ - buffer_.size());
+  buffer_.append(file_buffer_.data<char>() + file_buffer_offset_, size);
+  file_buffer_offset_ += size;
+
+  if (file_buffer_offset_ >= file_buffer_.size() && file_eof_) {
+    inflate_done_ = true;
+    end_inflate();
+  }
+
+  return size > 0;
+}
+
+bool FQFile::map_file() {
+  std::string path;
+  if (file_size_ == 0 || !local_path(uri_, &path))
+    return false;
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  void* map = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  // Compressed files are read through the VFS and zlib.
+  const uint8_t* magic = static_cast<const uint8_t*>(map);
+  if (file_size_ >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+    munmap(map, file_size_);
+    return false;
+  }
+  madvise(map, file_size_, MADV_SEQUENTIAL);
+  map_ = static_cast<const char*>(map);
+  map_size_ = file_size_;
   return true;
 }
 
+void FQFile::unmap_file() {
+  if (map_ != nullptr) {
+    munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+  }
+}
+
+void FQFile::read_file_buffer() {
+  // Keep the bytes not consumed yet, and append the next piece of the file.
+  const size_t remaining = file_buffer_.size() - file_buffer_offset_;
+  if (remaining > 0 && file_buffer_offset_ > 0)
+    std::memmove(
+        file_buffer_.data<char>(),
+        file_buffer_.data<char>() + file_buffer_offset_,
+        remaining);
+  file_buffer_offset_ = 0;
+
+  size_t to_read =
+      std::max<size_t>(file_buffer_bytes_, 2 * bgzf::MAX_BLOCK_SIZE);
+  if (!stream_)
+    to_read = std::min<size_t>(to_read, file_size_ - file_offset_);
+  file_buffer_.resize(remaining + to_read);
+  is_->read(file_buffer_.data<char>() + remaining, to_read);
+
+  // A stream ends with a short read; a file must have all its bytes.
+  const size_t num_read = static_cast<size_t>(is_->gcount());
+  if (is_->bad() || (num_read != to_read && !(stream_ && is_->eof()))) {
+    const char* err_c_str = strerror(errno);
+    throw std::runtime_error(
+        "Error reading from file '" + uri_ + "'; " + std::string(err_c_str));
+  }
+  file_buffer_.resize(remaining + num_read);
+  file_offset_ += num_read;
+  file_eof_ = stream_ ? num_read < to_read : file_offset_ >= file_size_;
+}
+
+void FQFile::init_inflate() {
+  end_inflate();
+
+  // Allocate inflate state
+  strm_.zalloc = Z_NULL;
+  strm_.zfree = Z_NULL;
+  strm_.opaque = Z_NULL;
+  strm_.avail_in = 0;
+  strm_.next_in = Z_NULL;
+
+  const int window_bits = 32;  // 32 = auto detect header
+  if (inflateInit2(&strm_, window_bits) != Z_OK)
+    throw std::runtime_error("Error decompressing; zlib stream init failed.");
+  strm_init_ = true;
+}
+
+void FQFile::end_inflate() {
+  if (strm_init_) {
+    inflateEnd(&strm_);
+    strm_init_ = false;
+  }
+}
+
 void FQFile::init_tiledb() {
   if (ctx_ == nullptr)
     ctx_.reset(new tiledb::Context);
@@ -29,10 +29,14 @@
 
 #include <tiledb/context.h>
 #include <tiledb/vfs.h>
+#include <zlib.h>
+#include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "utils/buffer.h"
+#include "utils/thread_pool.h"
 
 namespace tiledb {
 namespace fq {
@@ -47,46 +51,238 @@ class FQFile {
     std::vector<uint8_t> qualities;
   };
 
+  /** A range of characters in a buffer. */
+  struct Span {
+    const char* data;
+    size_t size;
+
+    std::string str() const {
+      return std::string(data, size);
+    }
+  };
+
+  /**
+   * A record parsed in place, whose fields point into the buffer it was
+   * parsed from. The quality string is not converted to scores.
+   */
+  struct FQRecordView {
+    Span header;
+    Span sequence;
+    Span description;
+    Span quality;
+  };
+
   /** Constructor. */
   FQFile();
 
+  /** Destructor. */
+  ~FQFile();
+
   /** Unimplemented rule-of-5. */
   FQFile(FQFile&&) = delete;
   FQFile(const FQFile&) = delete;
   FQFile& operator=(FQFile&&) = delete;
   FQFile& operator=(const FQFile&) = delete;
 
+  /**
+   * Opens a FastQ file, gzip-compressed (BGZF or not) or plain. The URI may
+   * also name a stream of unknown size, see is_stream().
+   *
+   * @throws std::runtime_error if the file does not exist.
+   */
   void open(const std::string& uri);
 
+  /**
+   * Returns true if the URI is read as a stream: "-" for stdin, or a local
+   * path that is not a regular file, such as a FIFO. Streams are read once,
+   * front to back.
+   */
+  static bool is_stream(const std::string& uri);
+
   bool next_record(FQRecord* record);
 
+  /**
+   * Moves the unparsed records of the current window into the given buffer,
+   * reading the next window first if needed. The chunk always ends on a record
+   * boundary; the chunk's previous allocation is reused for the next window.
+   * Chunks of a mapped file are views of the mapping, which stay valid until
+   * the file is closed; hand them back with release_chunk().
+   *
+   * @param chunk Buffer that will hold the chunk
+   * @return False if there are no more records in the file.
+   */
+  bool next_chunk(Buffer* chunk);
+
+  /**
+   * Hands back a chunk whose records are no longer needed. The pages of the
+   * mapping under a chunk of a mapped file are released, as the file is read
+   * once. May be called from other threads than next_chunk().
+   *
+   * @param chunk Chunk returned by next_chunk()
+   */
+  void release_chunk(const Buffer& chunk) const;
+
+  /**
+   * Parses the record starting at the given position.
+   *
+   * @param begin Start of the record
+   * @param end End of the chunk containing the record
+   * @param record Set to the parsed record
+   * @return Position one past the end of the parsed record
+   */
+  static const char* parse_record(
+      const char* begin, const char* end, FQRecord* record);
+
+  /**
+   * Parses the record starting at the given position, without copying it.
+   * The quality string is only checked to be as long as the sequence.
+   *
+   * @param begin Start of the record
+   * @param end End of the chunk containing the record
+   * @param record Set to the parsed record, valid while the chunk is
+   * @return Position one past the end of the parsed record
+   */
+  static const char* parse_record_view(
+      const char* begin, const char* end, FQRecordView* record);
+
+  /**
+   * Converts a Phred+33 quality string to scores.
+   *
+   * @param quality Quality string
+   * @param result Set to the scores, with room for quality.size scores
+   *
+   * @throws std::runtime_error if the string has invalid characters.
+   */
+  static void parse_quality_string(const Span& quality, uint8_t* result);
+
+  /**
+   * Sets the memory budget for buffering the file. The decompressed window
+   * and the compressed read buffer together stay within this budget, unless a
+   * single record is larger than the window.
+   */
+  void set_memory_budget(unsigned memory_budget_mb);
+
+  /** Sets the memory budget for buffering the file, in bytes. */
+  void set_memory_budget_bytes(uint64_t memory_budget_bytes);
+
+  /**
+   * Sets the number of threads used to inflate BGZF input. Other gzip input
+   * is inflated by a single thread.
+   */
+  void set_num_threads(unsigned num_threads);
+
+  /** Returns the number of (compressed) bytes read from the file so far. */
+  uint64_t num_bytes_read() const;
+
+  /**
+   * Returns true if the file is BGZF, whose blocks are inflated by the
+   * threads set with set_num_threads().
+   */
+  bool is_bgzf() const;
+
+  /**
+   * Returns true if the file is read through a memory mapping, which is the
+   * case for uncompressed local files.
+   */
+  bool is_mapped() const;
+
  private:
-  const size_t file_buffer_bytes_ = 1024;
+  /** Number of compressed bytes read from the file at a time. */
+  size_t file_buffer_bytes_;
+
+  /** Target size of the decompressed window. */
+  size_t window_bytes_;
 
   std::string uri_;
 
+  /** Size of the file, unused for streams. */
   size_t file_size_;
 
+  /** Number of compressed bytes read from the file so far. */
+  size_t file_offset_;
+
+  /** True if the input is a stream of unknown size. */
+  bool stream_;
+
+  /** True once the whole file has been read. */
+  bool file_eof_;
+
+  /** Compressed bytes read from the file, not yet fully inflated. */
+  Buffer file_buffer_;
+
+  /** Offset in the compressed buffer of the next BGZF block. */
+  size_t file_buffer_offset_;
+
+  /** True while the input is being read as a series of BGZF blocks. */
+  bool bgzf_;
+
+  /** True if the input is not compressed. */
+  bool plain_;
+
+  /** The whole file mapped in memory, or null if it is read in pieces. */
+  const char* map_;
+
+  /** Size of the mapping. */
+  size_t map_size_;
+
+  /** The current decompressed window, a view of the mapping if mapped. */
   Buffer buffer_;
 
+  /** Offset in the window of the next record to parse. */
   size_t buffer_offset_;
 
+  /** Offset in the window one past the last complete record. */
+  size_t records_end_;
+
+  /** zlib inflate state, persisted across windows. */
+  z_stream strm_;
+
+  /** True if the zlib stream has been initialized. */
+  bool strm_init_;
+
+  /** True once the whole file has been inflated. */
+  bool inflate_done_;
+
   std::unique_ptr<tiledb::Context> ctx_;
 
   std::unique_ptr<tiledb::VFS> vfs_;
 
-  void parse_record(FQRecord* record);
+  std::unique_ptr<tiledb::VFS::filebuf> filebuf_;
+
+  std::unique_ptr<std::istream> is_;
+
+  /** Thread pool for inflating BGZF blocks, if multithreaded. */
+  std::unique_ptr<ThreadPool> pool_;
 
   bool read_fq_chunk();
 
+  /** Points the window at the next records of the mapping. */
+  bool map_window();
+
+  /**
+   * Maps the file in memory if it is a local, non-empty, uncompressed file.
+   *
+   * @return True if the file was mapped
+   */
+  bool map_file();
+
+  void unmap_file();
+
   void init_tiledb();
 
-  void decompress_buffer();
+  void init_inflate();
+
+  void end_inflate();
+
+  bool inflate_more();
+
+  bool inflate_bgzf();
+
+  bool copy_plain();
 
-  void copy_to_delim(const char* src, char delim, std::string* dest) const;
+  void read_file_buffer();
 
-  void parse_quality_string(
-      const std::string& quality_string, std::vector<uint8_t>* result) const;
+  size_t find_records_end(size_t start) const;
 };
 
 }  // namespace fq
@@ -0,0 +1,248 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "utils/sequence_codec.h"
+#include "write/record_batch.h"
+
+namespace tiledb {
+namespace fq {
+
+namespace {
+/** Appends a header or description as a cell, see FIELD_PADDING. */
+void append_field(Buffer* buffer, const char* data, size_t size) {
+  if (is_padding(data, size))
+    buffer->append(&FIELD_PADDING, 1);
+  buffer->append(data, size);
+}
+}  // namespace
+
+bool is_padding(const char* data, size_t size) {
+  return std::all_of(
+      data, data + size, [](char c) { return c == FIELD_PADDING; });
+}
+
+RecordBatch::RecordBatch(const StorageFormat& format)
+    : format_(format)
+    , num_records_(0)
+    , header_fields_(format.header_template.size())
+    , header_tokens_(format.header_template.size()) {
+  if (!format_.quality_bin_table.empty()) {
+    quality_index_.resize(quality_bins::MAX_SCORE + 1);
+    quality_bins::make_index_table(
+        format_.quality_bin_table, quality_index_.data());
+  }
+}
+
+void RecordBatch::append(const FQFile::FQRecordView& record) {
+  header_.offsets().push_back(header_.size());
+  if (!format_.header_template.empty())
+    append_header_fields(record.header);
+  else
+    append_field(&header_, record.header.data, record.header.size);
+  if (format_.header_index) {
+    const size_t name_length = header_index::name_length(
+        record.header.data, record.header.size);
+    name_hashes_.push_back(
+        header_index::hash_name(record.header.data, name_length));
+  }
+
+  const size_t read_length = record.sequence.size;
+  const bool fixed = format_.fixed_read_length > 0;
+  if (fixed && read_length != format_.fixed_read_length)
+    throw std::runtime_error(
+        "Error ingesting record '" + record.header.str() + "'; read length " +
+        std::to_string(read_length) + " differs from fixed read length " +
+        std::to_string(format_.fixed_read_length) + ".");
+
+  // Empty cells are not allowed; store placeholders for empty reads.
+  const bool empty = read_length == 0;
+  const char* bases = empty ? "N" : record.sequence.data;
+  const size_t num_bases = empty ? 1 : read_length;
+
+  if (format_.sequence_encoding == SequenceEncoding::TwoBit) {
+    const size_t offset = sequence_.size();
+    sequence_.offsets().push_back(offset);
+    sequence_.resize(offset + sequence_codec::max_encoded_size(num_bases));
+    const size_t encoded_size = sequence_codec::encode(
+        bases, num_bases, sequence_.data<uint8_t>() + offset);
+    sequence_.resize(offset + encoded_size);
+  } else {
+    if (!fixed)
+      sequence_.offsets().push_back(sequence_.size());
+    sequence_.append(bases, num_bases);
+  }
+
+  if (!fixed)
+    quality_.offsets().push_back(quality_.size());
+  if (empty) {
+    quality_.append(&EMPTY_READ_QUALITY, 1);
+  } else {
+    const size_t offset = quality_.size();
+    quality_.resize(offset + read_length);
+    uint8_t* dest = quality_.data<uint8_t>() + offset;
+    FQFile::parse_quality_string(record.quality, dest);
+    if (!quality_index_.empty()) {
+      for (size_t i = 0; i < read_length; i++)
+        dest[i] = quality_index_[dest[i]];
+    }
+  }
+
+  if (format_.description_encoding == DescriptionEncoding::Kinds) {
+    const auto kind = descriptions::kind(
+        record.header.data,
+        record.header.size,
+        record.description.data,
+        record.description.size);
+    description_kinds_.push_back(uint8_t(kind));
+    if (kind == descriptions::Kind::Explicit) {
+      explicit_descriptions_.push_back(num_records_);
+      description_.offsets().push_back(description_.size());
+      description_.append(record.description.data, record.description.size);
+    }
+  } else {
+    description_.offsets().push_back(description_.size());
+    append_field(
+        &description_, record.description.data, record.description.size);
+  }
+
+  num_records_++;
+}
+
+void RecordBatch::append_header_fields(const FQFile::Span& header) {
+  // Headers that do not match the template are stored verbatim, with
+  // placeholder fields.
+  const auto& fields = format_.header_template;
+  const bool match = header_tokens::split(
+      fields, header.data, header.size, header_tokens_.data());
+  if (match)
+    header_.append(&header_tokens::MATCHED_HEADER, 1);
+  else
+    append_field(&header_, header.data, header.size);
+
+  for (size_t f = 0; f < fields.size(); f++) {
+    Buffer& buffer = header_fields_[f];
+    const header_tokens::Token& token = header_tokens_[f];
+    if (fields[f].kind == header_tokens::FieldKind::Integer) {
+      const uint64_t value = match ? token.number : 0;
+      buffer.append(&value, sizeof(value));
+    } else if (fields[f].kind == header_tokens::FieldKind::String) {
+      buffer.offsets().push_back(buffer.size());
+      if (match)
+        buffer.append(token.data, token.size);
+      else
+        buffer.append("-", 1);
+    }
+  }
+}
+
+void RecordBatch::clear() {
+  header_.clear();
+  for (auto& buffer : header_fields_)
+    buffer.clear();
+  sequence_.clear();
+  description_.clear();
+  description_kinds_.clear();
+  explicit_descriptions_.clear();
+  quality_.clear();
+  name_hashes_.clear();
+  num_records_ = 0;
+}
+
+uint64_t RecordBatch::num_records() const {
+  return num_records_;
+}
+
+uint64_t RecordBatch::size() const {
+  uint64_t num_offsets =
+      header_.offsets().size() + sequence_.offsets().size() +
+      description_.offsets().size() + quality_.offsets().size();
+  uint64_t size = header_.size() + sequence_.size() + description_.size() +
+                  description_kinds_.size() + quality_.size() +
+                  explicit_descriptions_.size() * sizeof(uint64_t);
+  for (const auto& buffer : header_fields_) {
+    num_offsets += buffer.offsets().size();
+    size += buffer.size();
+  }
+  return size + num_offsets * sizeof(uint64_t);
+}
+
+uint64_t RecordBatch::alloced_size() const {
+  uint64_t size = name_hashes_.capacity() * sizeof(header_index::NameHash) +
+                  description_kinds_.capacity() +
+                  explicit_descriptions_.capacity() * sizeof(uint64_t);
+  for (const Buffer* b : {&header_, &sequence_, &description_, &quality_})
+    size += b->alloced_size() + b->offsets().capacity() * sizeof(uint64_t);
+  for (const auto& b : header_fields_)
+    size += b.alloced_size() + b.offsets().capacity() * sizeof(uint64_t);
+  return size;
+}
+
+void RecordBatch::set_query_buffers(tiledb::Query* query) {
+  header_.set_query_buffer<char>("header", *query);
+  const auto& fields = format_.header_template;
+  for (size_t f = 0; f < fields.size(); f++) {
+    Buffer& buffer = header_fields_[f];
+    const std::string name = header_tokens::attribute_name(f);
+    if (fields[f].kind == header_tokens::FieldKind::Integer)
+      query->set_buffer(
+          name, buffer.data<uint64_t>(), buffer.nelts<uint64_t>());
+    else if (fields[f].kind == header_tokens::FieldKind::String)
+      buffer.set_query_buffer<char>(name, *query);
+  }
+  if (format_.description_encoding == DescriptionEncoding::Kinds)
+    query->set_buffer(descriptions::KIND_ATTRIBUTE, description_kinds_);
+  else
+    description_.set_query_buffer<char>("description", *query);
+  const bool fixed = format_.fixed_read_length > 0;
+  if (format_.sequence_encoding == SequenceEncoding::TwoBit)
+    sequence_.set_query_buffer<uint8_t>("sequence", *query);
+  else if (fixed)
+    query->set_buffer("sequence", sequence_.data<char>(), sequence_.size());
+  else
+    sequence_.set_query_buffer<char>("sequence", *query);
+
+  if (fixed)
+    query->set_buffer("quality", quality_.data<uint8_t>(), quality_.size());
+  else
+    quality_.set_query_buffer<uint8_t>("quality", *query);
+}
+
+const std::vector<header_index::NameHash>& RecordBatch::name_hashes() const {
+  return name_hashes_;
+}
+
+const std::vector<uint64_t>& RecordBatch::explicit_descriptions() const {
+  return explicit_descriptions_;
+}
+
+Buffer* RecordBatch::explicit_description_buffer() {
+  return &description_;
+}
+
+}  // namespace fq
+}  // namespace tiledb
@@ -0,0 +1,156 @@
+/**
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TILEDB_FASTQ_RECORD_BATCH_H
+#define TILEDB_FASTQ_RECORD_BATCH_H
+
+#include <tiledb/tiledb>
+
+#include "utils/buffer.h"
+#include "utils/descriptions.h"
+#include "utils/header_index.h"
+#include "utils/header_tokens.h"
+#include "utils/storage_format.h"
+#include "write/fqfile.h"
+
+namespace tiledb {
+namespace fq {
+
+/**
+ * Quality cell stored for reads of length zero. TileDB does not allow empty
+ * var-length cells, and no Phred score has this value.
+ */
+const uint8_t EMPTY_READ_QUALITY = 0xff;
+
+/**
+ * Headers and descriptions made only of dashes, including empty ones, are
+ * stored with one more dash, as empty cells are not allowed either. Empty
+ * descriptions are thus stored as "-", and a description of "-" as "--".
+ */
+const char FIELD_PADDING = '-';
+
+/**
+ * Returns true if a header or description is made only of FIELD_PADDING, or
+ * is empty. Stored cells for which this holds have the extra padding.
+ */
+bool is_padding(const char* data, size_t size);
+
+/**
+ * Attribute buffers for a batch of consecutive FastQ records, written to the
+ * array with a single query.
+ */
+class RecordBatch {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param format How the records are stored in the array
+   */
+  explicit RecordBatch(const StorageFormat& format = StorageFormat());
+
+  /**
+   * Appends a record to the batch, copying its fields straight from the
+   * buffer it was parsed from.
+   *
+   * @throws std::runtime_error if the read does not have the fixed length,
+   *    or the quality string is invalid.
+   */
+  void append(const FQFile::FQRecordView& record);
+
+  /** Removes all records from the batch, keeping the allocations. */
+  void clear();
+
+  /** Returns the number of records in the batch. */
+  uint64_t num_records() const;
+
+  /** Returns the total size in bytes of the attribute buffers. */
+  uint64_t size() const;
+
+  /** Returns the memory allocated by the attribute buffers, in bytes. */
+  uint64_t alloced_size() const;
+
+  /** Sets the attribute buffers on the given write query. */
+  void set_query_buffers(tiledb::Query* query);
+
+  /** Returns the read name hashes, if the format has a header index. */
+  const std::vector<header_index::NameHash>& name_hashes() const;
+
+  /**
+   * Returns the indices in the batch of the records with explicit
+   * descriptions, if the descriptions are stored as kinds.
+   */
+  const std::vector<uint64_t>& explicit_descriptions() const;
+
+  /**
+   * Returns the explicit descriptions, in order, to be written to the
+   * descriptions array.
+   */
+  Buffer* explicit_description_buffer();
+
+ private:
+  StorageFormat format_;
+
+  /** Bin index of each quality score, or empty if lossless. */
+  std::vector<uint8_t> quality_index_;
+
+  uint64_t num_records_;
+
+  Buffer header_;
+
+  /**
+   * Values of the fields of the header template, one buffer per field.
+   * Constant fields have empty buffers.
+   */
+  std::vector<Buffer> header_fields_;
+
+  /** Fields of the header being appended. */
+  std::vector<header_tokens::Token> header_tokens_;
+
+  Buffer sequence_;
+
+  /**
+   * The descriptions if stored raw, otherwise only the explicit
+   * descriptions.
+   */
+  Buffer description_;
+
+  /** Kind of each description, if the descriptions are stored as kinds. */
+  std::vector<uint8_t> description_kinds_;
+
+  std::vector<uint64_t> explicit_descriptions_;
+
+  Buffer quality_;
+
+  std::vector<header_index::NameHash> name_hashes_;
+
+  /** Appends a header as the fields of the header template. */
+  void append_header_fields(const FQFile::Span& header);
+};
+
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_RECORD_BATCH_H
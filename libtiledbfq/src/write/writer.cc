@@ -24,15 +24,191 @@
  * THE SOFTWARE.
  */
 
+#include <fnmatch.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <future>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <tiledb/tiledb>
 
+#include "utils/bounded_queue.h"
+#include "utils/descriptions.h"
+#include "utils/header_index.h"
+#include "utils/scan.h"
+#include "utils/utils.h"
 #include "write/fqfile.h"
+#include "write/record_batch.h"
 #include "write/writer.h"
 
 namespace tiledb {
 namespace fq {
 
+namespace {
+/** Returns true if the file name has a FastQ extension. */
+bool is_fastq_name(const std::string& name) {
+  for (const char* ext : {".fastq", ".fq"}) {
+    for (const char* gz : {"", ".gz", ".bgz"}) {
+      if (utils::ends_with(name, std::string(ext) + gz))
+        return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Makes sure the chunk has records left past the given offset, reading the
+ * next chunk of the file into it if needed.
+ *
+ * @return False if the file has no more records
+ */
+bool refill_chunk(FQFile* fq, Buffer* chunk, size_t* offset) {
+  while (*offset == chunk->size()) {
+    fq->release_chunk(*chunk);
+    *offset = 0;
+    if (!fq->next_chunk(chunk)) {
+      chunk->clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Finds the ends of the next records of a chunk of whole records. The last
+ * record of a file may be missing its trailing newline, in which case it ends
+ * at the end of the chunk.
+ *
+ * @param p Start of the next record
+ * @param end End of the chunk
+ * @param newlines Scratch space, for a quarter as many records
+ * @param record_ends Set to the ends of the records found
+ * @return Number of records found
+ */
+size_t find_record_ends(
+    const char* p,
+    const char* end,
+    std::vector<const char*>* newlines,
+    std::vector<const char*>* record_ends) {
+  const size_t num_newlines =
+      scan::find_newlines(p, end, newlines->size(), newlines->data());
+  size_t num_records = num_newlines / 4;
+  for (size_t i = 0; i < num_records; i++)
+    (*record_ends)[i] = (*newlines)[4 * i + 3] + 1;
+  const char* last_end = num_records > 0 ? (*record_ends)[num_records - 1] : p;
+  if (num_newlines < newlines->size() && last_end < end)
+    (*record_ends)[num_records++] = end;
+  return num_records;
+}
+
+/**
+ * Appends records of two chunks of whole records to the output, alternating
+ * between them, until either chunk runs out.
+ */
+void interleave_records(
+    const Buffer& chunk,
+    size_t* offset,
+    const Buffer& mate_chunk,
+    size_t* mate_offset,
+    Buffer* output) {
+  const size_t block_records = 1024;
+  std::vector<const char*> newlines(4 * block_records);
+  std::vector<const char*> record_ends(block_records);
+  std::vector<const char*> mate_record_ends(block_records);
+  const char* end = chunk.data<char>() + chunk.size();
+  const char* mate_end = mate_chunk.data<char>() + mate_chunk.size();
+
+  // A record missing its trailing newline gets one, so that its mate starts
+  // on a new line.
+  auto append_record = [output](const char* begin, const char* end) {
+    output->append(begin, end - begin);
+    if (end[-1] != '\n')
+      output->append("\n", 1);
+  };
+  for (;;) {
+    const char* p = chunk.data<char>() + *offset;
+    const char* mate_p = mate_chunk.data<char>() + *mate_offset;
+    const size_t num_records =
+        find_record_ends(p, end, &newlines, &record_ends);
+    const size_t mate_num_records =
+        find_record_ends(mate_p, mate_end, &newlines, &mate_record_ends);
+    const size_t num_pairs = std::min(num_records, mate_num_records);
+    if (num_pairs == 0)
+      return;
+
+    for (size_t i = 0; i < num_pairs; i++) {
+      append_record(p, record_ends[i]);
+      p = record_ends[i];
+      append_record(mate_p, mate_record_ends[i]);
+      mate_p = mate_record_ends[i];
+    }
+    *offset = p - chunk.data<char>();
+    *mate_offset = mate_p - mate_chunk.data<char>();
+  }
+}
+
+/**
+ * Calls fn with each index from 0 to num_items - 1, from concurrent worker
+ * threads that take the indexes in order.
+ *
+ * @return The first error thrown by fn, after which the workers take no
+ *    more indexes, or null
+ */
+std::exception_ptr run_workers(
+    size_t num_items,
+    unsigned num_workers,
+    const std::function<void(size_t)>& fn) {
+  std::atomic<size_t> next_item(0);
+  std::mutex error_mtx;
+  std::exception_ptr error;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < num_workers; i++) {
+    workers.emplace_back([&]() {
+      try {
+        for (size_t item = next_item++; item < num_items; item = next_item++)
+          fn(item);
+      } catch (...) {
+        std::unique_lock<std::mutex> lck(error_mtx);
+        if (!error)
+          error = std::current_exception();
+        next_item = num_items;
+      }
+    });
+  }
+  for (auto& t : workers)
+    t.join();
+  return error;
+}
+
+/**
+ * Returns the read name of a header, without the '/1' or '/2' suffix that
+ * marks the mate in older Illumina headers.
+ */
+FQFile::Span mate_name(const FQFile::Span& header) {
+  size_t size = header_index::name_length(header.data, header.size);
+  if (size >= 2 && header.data[size - 2] == '/' &&
+      (header.data[size - 1] == '1' || header.data[size - 1] == '2'))
+    size -= 2;
+  return {header.data, size};
+}
+
+/** Checks that the two mates of a pair have the same read name. */
+void check_mate_names(const FQFile::Span& first, const FQFile::Span& second) {
+  const FQFile::Span name = mate_name(first);
+  const FQFile::Span mate = mate_name(second);
+  if (name.size != mate.size ||
+      std::memcmp(name.data, mate.data, name.size) != 0)
+    throw std::runtime_error(
+        "Error ingesting; read names of mates '" + first.str() + "' and '" +
+        second.str() + "' differ.");
+}
+}  // namespace
+
 Writer::Writer() {
 }
 
@@ -40,6 +216,10 @@ void Writer::set_all_params(const IngestionParams& args) {
   args_ = args;
 }
 
+const Stats& Writer::stats() const {
+  return stats_;
+}
+
 void Writer::init_tiledb() {
   if (ctx_ == nullptr)
     ctx_.reset(new tiledb::Context);
@@ -47,49 +227,625 @@ void Writer::init_tiledb() {
 
 void Writer::ingest() {
   init_tiledb();
-  create_array();
+  stats_.clear();
+
+  inputs_ = resolve_input(args_.input_uri);
+  for (const auto& uri : args_.more_input_uris) {
+    auto files = resolve_input(uri);
+    inputs_.insert(inputs_.end(), files.begin(), files.end());
+  }
+  mate_inputs_.clear();
+  if (!args_.mate_input_uri.empty()) {
+    mate_inputs_ = resolve_input(args_.mate_input_uri);
+    if (mate_inputs_.size() != inputs_.size())
+      throw std::runtime_error(
+          "Error ingesting; found " + std::to_string(inputs_.size()) +
+          " input files but " + std::to_string(mate_inputs_.size()) +
+          " mate input files.");
+    // Tiles hold whole pairs, as the mates are records 2i and 2i+1.
+    if (args_.tile_extent % 2 != 0)
+      throw std::runtime_error(
+          "Error ingesting; the tile extent of paired-end reads must be even, "
+          "got " + std::to_string(args_.tile_extent) + ".");
+  }
+
+  const std::string index_uri = header_index::index_uri(args_.uri);
+  const std::string descriptions_uri = descriptions::array_uri(args_.uri);
+  uint64_t first_record = 0;
+  if (args_.append) {
+    first_record = open_for_append();
+    if (args_.verbose)
+      std::cout << "Appending after record " << first_record << std::endl;
+  } else {
+    format_.sequence_encoding = args_.pack_sequences ?
+                                    SequenceEncoding::TwoBit :
+                                    SequenceEncoding::Raw;
+    format_.quality_bin_table = quality_bin_table();
+    format_.header_index = args_.header_index;
+    format_.paired = !mate_inputs_.empty();
+    format_.filters = compression_config();
+    format_.description_encoding = args_.encode_descriptions ?
+                                       DescriptionEncoding::Kinds :
+                                       DescriptionEncoding::Raw;
+    const auto samples = sample_records();
+    format_.tile_extent =
+        args_.tile_extent > 0 ? args_.tile_extent : choose_tile_extent(samples);
+    if (args_.verbose)
+      std::cout << "Storing " << format_.tile_extent << " records per tile"
+                << std::endl;
+    if (args_.tokenize_headers) {
+      format_.header_template = infer_header_template(samples);
+      if (args_.verbose)
+        std::cout << "Storing headers with template '"
+                  << header_tokens::to_string(format_.header_template) << "'"
+                  << std::endl;
+    }
+
+    // Fixed-length cells avoid the offsets, but are only valid if every read
+    // has the same length. Checking that takes an extra pass over the input.
+    format_.fixed_read_length =
+        args_.scan_read_length ? scan_read_length() : 0;
+    if (args_.verbose && format_.fixed_read_length > 0)
+      std::cout << "Storing fixed-length reads of length "
+                << format_.fixed_read_length << std::endl;
+    else if (args_.verbose)
+      std::cout << "Storing variable-length reads" << std::endl;
+    if (args_.verbose)
+      std::cout << "Compressing with preset '" << format_.filters.preset
+                << "': " << compression::to_string(format_.filters)
+                << std::endl;
+    create_array(format_);
+    if (format_.header_index)
+      header_index::create(*ctx_, index_uri);
+    if (format_.description_encoding == DescriptionEncoding::Kinds)
+      descriptions::create(
+          *ctx_, descriptions_uri, make_filters(format_, "description"));
+  }
+
+  // Files are ingested by concurrent workers, which split the threads and
+  // the memory budget evenly. A stream can only be read once, so input with
+  // a stream is ingested one file at a time.
+  const unsigned num_threads = std::max(args_.num_threads, 1u);
+  const bool has_stream =
+      std::any_of(inputs_.begin(), inputs_.end(), FQFile::is_stream);
+  const unsigned num_workers = has_stream ?
+                                   1 :
+                                   (unsigned)std::min<size_t>(
+                                       inputs_.size(),
+                                       args_.num_file_workers > 0 ?
+                                           args_.num_file_workers :
+                                           num_threads);
+  const unsigned worker_threads = std::max(num_threads / num_workers, 1u);
+  const uint64_t budget_bytes =
+      uint64_t(std::max(args_.memory_budget_mb, 1u)) * 1024 * 1024 /
+      num_workers;
+  if (args_.verbose)
+    std::cout << "Ingesting " << inputs_.size() << " file(s) with "
+              << num_workers << " worker(s)" << std::endl;
+
+  // Each parser, at most one per thread of the worker, holds one chunk and
+  // one batch; the extra ones keep the reader and writer stages busy. Every
+  // chunk and batch (plus the input window) gets an equal share of half of
+  // the budget. The other half is headroom for buffer growth and for
+  // TileDB's own copies of the tiles during writes. Paired input adds the
+  // mate window and a chunk of each file being interleaved.
+  const unsigned num_buffers =
+      2 * (worker_threads + 2) + (format_.paired ? 4 : 1);
+  const uint64_t window_bytes = budget_bytes / (2 * num_buffers);
+
+  tiledb::Array array(*ctx_, args_.uri, TILEDB_WRITE);
+  if (!args_.append)
+    format_.put_metadata(&array);
+  if (format_.header_index)
+    index_array_.reset(new tiledb::Array(*ctx_, index_uri, TILEDB_WRITE));
+  if (format_.description_encoding == DescriptionEncoding::Kinds)
+    descriptions_array_.reset(
+        new tiledb::Array(*ctx_, descriptions_uri, TILEDB_WRITE));
+  // Each file is stored as a contiguous range of records, in input order. A
+  // single worker takes the files in order, each starting where the last
+  // ended. Concurrent workers first count the records of every file, so
+  // that each file starts at the same record whichever worker finishes
+  // first. A pair counts the records of both files.
+  std::vector<uint64_t> file_starts(inputs_.size() + 1, first_record);
+  std::exception_ptr error;
+  if (num_workers > 1) {
+    if (args_.verbose)
+      std::cout << "Counting the records of " << inputs_.size() << " files"
+                << std::endl;
+    std::vector<uint64_t> counts(inputs_.size());
+    error = run_workers(inputs_.size(), num_workers, [&](size_t f) {
+      ScopedTimer timer(&stats_.timer("count_records"));
+      counts[f] = (format_.paired ? 2 : 1) *
+                  count_records(inputs_[f], window_bytes, worker_threads);
+    });
+    for (size_t f = 0; f < counts.size(); f++)
+      file_starts[f + 1] = file_starts[f] + counts[f];
+  }
+
+  if (args_.verbose && !error)
+    stats_.start_progress(&std::cout, "records_parsed", "bytes_inflated");
+  if (!error) {
+    error = run_workers(inputs_.size(), num_workers, [&](size_t f) {
+      FQFile fq;
+      fq.set_memory_budget_bytes(window_bytes);
+      fq.open(inputs_[f]);
+      std::unique_ptr<FQFile> mate_fq;
+      if (format_.paired) {
+        mate_fq.reset(new FQFile);
+        mate_fq->set_memory_budget_bytes(window_bytes);
+        mate_fq->open(mate_inputs_[f]);
+      }
 
+      // BGZF files take half of the worker's threads to inflate, split
+      // between the two files of a pair; the parsers get the rest.
+      const unsigned num_bgzf =
+          (fq.is_bgzf() ? 1 : 0) + (mate_fq && mate_fq->is_bgzf() ? 1 : 0);
+      const unsigned num_inflaters = num_bgzf > 0 ? worker_threads / 2 : 0;
+      if (fq.is_bgzf())
+        fq.set_num_threads(num_inflaters / num_bgzf);
+      if (mate_fq != nullptr && mate_fq->is_bgzf())
+        mate_fq->set_num_threads(num_inflaters / num_bgzf);
+      const uint64_t num_records = ingest_file(
+          &fq,
+          mate_fq.get(),
+          inputs_[f],
+          format_.paired ? mate_inputs_[f] : "",
+          array,
+          file_starts[f],
+          std::max(worker_threads - num_inflaters, 1u));
+      if (num_workers == 1)
+        file_starts[f + 1] = file_starts[f] + num_records;
+      else if (num_records != file_starts[f + 1] - file_starts[f])
+        throw std::runtime_error(
+            "Error ingesting '" + inputs_[f] + "'; read " +
+            std::to_string(num_records) + " records, but counted " +
+            std::to_string(file_starts[f + 1] - file_starts[f]) +
+            " before. Did the file change?");
+      stats_.counter("files_ingested")++;
+      if (args_.verbose)
+        std::cout << "Ingested " << num_records << " records from "
+                  << inputs_[f] << std::endl;
+    });
+  }
+  stats_.stop_progress();
+  array.close();
+
+  // Every batch wrote an index fragment; merge them for fast lookups.
+  if (index_array_ != nullptr) {
+    index_array_->close();
+    index_array_.reset();
+    if (!error) {
+      ScopedTimer timer(&stats_.timer("index_consolidate"));
+      tiledb::Array::consolidate(*ctx_, index_uri);
+    }
+  }
+  if (descriptions_array_ != nullptr) {
+    descriptions_array_->close();
+    descriptions_array_.reset();
+    if (!error && stats_.counter("explicit_descriptions") > 0) {
+      ScopedTimer timer(&stats_.timer("descriptions_consolidate"));
+      tiledb::Array::consolidate(*ctx_, descriptions_uri);
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+
+  if (args_.verbose)
+    std::cout << "Ingestion statistics: " << stats_.to_json();
+  if (!args_.stats_uri.empty())
+    utils::write_file(tiledb::VFS(*ctx_), args_.stats_uri, stats_.to_json());
+}
+
+uint64_t Writer::open_for_append() {
+  tiledb::Array array(*ctx_, args_.uri, TILEDB_READ);
+  format_ = StorageFormat();
+  format_.get_metadata(&array);
+  const bool paired = !mate_inputs_.empty();
+  if (paired != format_.paired)
+    throw std::runtime_error(
+        "Error appending to array '" + args_.uri + "'; the array holds " +
+        (format_.paired ? "paired-end" : "single-end") +
+        " reads, but the input is " + (paired ? "paired-end." : "single-end."));
+
+  // Records are only ever written as contiguous ranges from 0, so the end of
+  // the non-empty domain is the last record.
+  auto non_empty = array.non_empty_domain<uint64_t>();
+  array.close();
+  return non_empty.empty() ? 0 : non_empty[0].second.second + 1;
+}
+
+std::vector<std::string> Writer::resolve_input(const std::string& uri) const {
+  tiledb::VFS vfs(*ctx_);
+  const size_t slash = uri.find_last_of('/');
+  const std::string name =
+      slash == std::string::npos ? uri : uri.substr(slash + 1);
+  const bool pattern = name.find_first_of("*?[") != std::string::npos;
+  if (!pattern && !vfs.is_dir(uri))
+    return {uri};
+
+  // List the directory, keeping the files matching the pattern, or the
+  // FastQ files if there is no pattern.
+  std::string dir = uri;
+  if (pattern)
+    dir = slash == std::string::npos ? "." : uri.substr(0, slash);
+  std::vector<std::string> files;
+  for (const auto& child : vfs.ls(dir)) {
+    const std::string child_name = child.substr(child.find_last_of('/') + 1);
+    const bool match =
+        pattern ? fnmatch(name.c_str(), child_name.c_str(), 0) == 0 :
+                  is_fastq_name(child_name);
+    if (match && vfs.is_file(child))
+      files.push_back(child);
+  }
+  if (files.empty())
+    throw std::runtime_error(
+        "Error ingesting; no FastQ files found for input '" + uri + "'");
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+uint64_t Writer::ingest_file(
+    FQFile* fq,
+    FQFile* mate_fq,
+    const std::string& uri,
+    const std::string& mate_uri,
+    const tiledb::Array& array,
+    uint64_t first_record,
+    unsigned num_parsers) {
+  const unsigned num_chunks = num_parsers + 2;
+  const unsigned num_batches = num_parsers + 2;
+
+  // Queues connecting the stages. The free lists recycle the buffers, which
+  // bounds the memory in flight. The full queues can hold every buffer, so
+  // pushing to them never blocks.
+  typedef std::pair<uint64_t, Buffer*> Chunk;
+  typedef std::pair<uint64_t, RecordBatch*> Batch;
+  BoundedQueue<Buffer*> free_chunks(num_chunks);
+  BoundedQueue<Chunk> full_chunks(num_chunks);
+  BoundedQueue<RecordBatch*> free_batches(num_batches);
+  BoundedQueue<Batch> full_batches(num_batches);
+
+  // Time waiting on a queue is time its producers are behind.
+  free_chunks.set_pop_wait_timer(&stats_.timer("wait_free_chunks"));
+  full_chunks.set_pop_wait_timer(&stats_.timer("wait_full_chunks"));
+  free_batches.set_pop_wait_timer(&stats_.timer("wait_free_batches"));
+  full_batches.set_pop_wait_timer(&stats_.timer("wait_full_batches"));
+  Stats::Counter& bytes_read = stats_.counter("bytes_read");
+  Stats::Counter& bytes_inflated = stats_.counter("bytes_inflated");
+  Stats::Counter& records_parsed = stats_.counter("records_parsed");
+  Stats::Counter& inflate_time = stats_.timer("inflate");
+  Stats::Counter& parse_time = stats_.timer("parse");
+  Stats::Counter& columnarize_time = stats_.timer("columnarize");
+  Stats::Counter& batch_bytes = stats_.peak("batch_bytes");
+
+  std::vector<std::unique_ptr<Buffer>> chunks;
+  for (unsigned i = 0; i < num_chunks; i++) {
+    chunks.emplace_back(new Buffer);
+    free_chunks.push(chunks.back().get());
+  }
+  std::vector<std::unique_ptr<RecordBatch>> batches;
+  for (unsigned i = 0; i < num_batches; i++) {
+    batches.emplace_back(new RecordBatch(format_));
+    free_batches.push(batches.back().get());
+  }
+
+  // The first error closes all queues, which stops every stage.
+  std::mutex error_mtx;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr e) {
+    {
+      std::unique_lock<std::mutex> lck(error_mtx);
+      if (!error)
+        error = e;
+    }
+    free_chunks.close();
+    full_chunks.close();
+    free_batches.close();
+    full_batches.close();
+  };
+
+  // Stage 1: decompress the input into chunks of whole records. Paired input
+  // is interleaved into chunks of whole pairs.
+  std::thread reader([&]() {
+    try {
+      uint64_t index = 0, last_bytes_read = 0;
+      Buffer* chunk;
+      Buffer input, mate_input;
+      size_t input_offset = 0, mate_input_offset = 0;
+      while (free_chunks.pop(&chunk)) {
+        bool more;
+        {
+          ScopedTimer timer(&inflate_time);
+          if (mate_fq == nullptr) {
+            more = fq->next_chunk(chunk);
+          } else {
+            more = refill_chunk(fq, &input, &input_offset);
+            const bool mate_more =
+                refill_chunk(mate_fq, &mate_input, &mate_input_offset);
+            if (more != mate_more)
+              throw std::runtime_error(
+                  "Error ingesting; the paired files '" + uri + "' and '" +
+                  mate_uri + "' have different numbers of records.");
+            if (more) {
+              chunk->clear();
+              interleave_records(
+                  input, &input_offset, mate_input, &mate_input_offset, chunk);
+            }
+          }
+        }
+        const uint64_t num_bytes_read =
+            fq->num_bytes_read() +
+            (mate_fq == nullptr ? 0 : mate_fq->num_bytes_read());
+        bytes_read += num_bytes_read - last_bytes_read;
+        last_bytes_read = num_bytes_read;
+        if (!more)
+          break;
+        // Chunks without records are not passed on.
+        if (chunk->size() == 0) {
+          free_chunks.push(chunk);
+          continue;
+        }
+        bytes_inflated += chunk->size();
+        if (!full_chunks.push({index++, chunk}))
+          break;
+      }
+      full_chunks.close();
+    } catch (...) {
+      fail(std::current_exception());
+    }
+  });
+
+  // Stage 2: parse the chunks into attribute buffers.
+  std::atomic<unsigned> parsers_running(num_parsers);
+  std::vector<std::thread> parsers;
+  for (unsigned i = 0; i < num_parsers; i++) {
+    parsers.emplace_back([&]() {
+      try {
+        // Records are parsed and appended to the batch in blocks, so that
+        // the two steps can be timed apart.
+        std::vector<FQFile::FQRecordView> records(1024);
+        FQFile::Span first_mate;
+        RecordBatch* batch;
+        Chunk chunk;
+        // Take a batch before a chunk, so the parser holding the next chunk
+        // to be written is never waiting for a batch.
+        while (free_batches.pop(&batch) && full_chunks.pop(&chunk)) {
+          batch->clear();
+          const char* p = chunk.second->data<char>();
+          const char* end = p + chunk.second->size();
+          uint64_t i = 0;
+          while (p < end) {
+            size_t n = 0;
+            {
+              ScopedTimer timer(&parse_time);
+              for (; n < records.size() && p < end; n++, i++) {
+                p = FQFile::parse_record_view(p, end, &records[n]);
+                // Chunks of paired input start at a pair.
+                if (mate_fq != nullptr && i % 2 == 0)
+                  first_mate = records[n].header;
+                else if (mate_fq != nullptr)
+                  check_mate_names(first_mate, records[n].header);
+              }
+            }
+            ScopedTimer timer(&columnarize_time);
+            for (size_t j = 0; j < n; j++)
+              batch->append(records[j]);
+          }
+          records_parsed += i;
+          Stats::update_peak(&batch_bytes, batch->size());
+          fq->release_chunk(*chunk.second);
+          free_chunks.push(chunk.second);
+          if (!full_batches.push({chunk.first, batch}))
+            break;
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+      if (--parsers_running == 0)
+        full_batches.close();
+    });
+  }
+
+  // Stage 3: write the batches, in input order.
+  uint64_t total_records = 0;
+  try {
+    std::map<uint64_t, RecordBatch*> pending;
+    uint64_t next_index = 0;
+    Batch batch;
+    while (full_batches.pop(&batch)) {
+      pending.insert(batch);
+      for (auto it = pending.find(next_index); it != pending.end();
+           it = pending.find(next_index)) {
+        const uint64_t num_records = it->second->num_records();
+        write_batch(array, first_record + total_records, it->second);
+        total_records += num_records;
+        free_batches.push(it->second);
+        pending.erase(it);
+        next_index++;
+      }
+    }
+  } catch (...) {
+    fail(std::current_exception());
+  }
+
+  reader.join();
+  for (auto& t : parsers)
+    t.join();
+  if (error)
+    std::rethrow_exception(error);
+
+  // Buffers never shrink, so their final size is their peak.
+  uint64_t buffer_bytes = 0;
+  for (const auto& chunk : chunks)
+    buffer_bytes += chunk->alloced_size();
+  for (const auto& batch : batches)
+    buffer_bytes += batch->alloced_size();
+  Stats::update_peak(&stats_.peak("pipeline_buffer_bytes"), buffer_bytes);
+
+  return total_records;
+}
+
+void Writer::write_batch(
+    const tiledb::Array& array, uint64_t record_start, RecordBatch* batch) {
+  if (batch->num_records() == 0)
+    return;
+
+  // Each batch is a contiguous range of records, written as its own fragment.
+  {
+    ScopedTimer timer(&stats_.timer("tiledb_submit"));
+    tiledb::Query query(*ctx_, array);
+    query.set_subarray(std::array<uint64_t, 2>{
+        record_start, record_start + batch->num_records() - 1});
+    batch->set_query_buffers(&query);
+    query.submit();
+  }
+  stats_.counter("records_written") += batch->num_records();
+  stats_.counter("fragments_written")++;
+
+  if (index_array_ != nullptr) {
+    ScopedTimer timer(&stats_.timer("index_write"));
+    header_index::write(
+        *ctx_, *index_array_, record_start, batch->name_hashes());
+  }
+
+  // The few explicit descriptions are written to the side array.
+  if (descriptions_array_ != nullptr &&
+      !batch->explicit_descriptions().empty()) {
+    ScopedTimer timer(&stats_.timer("descriptions_write"));
+    descriptions::write(
+        *ctx_,
+        *descriptions_array_,
+        record_start,
+        batch->explicit_descriptions(),
+        batch->explicit_description_buffer());
+    stats_.counter("explicit_descriptions") +=
+        batch->explicit_descriptions().size();
+  }
+}
+
+uint32_t Writer::scan_read_length() const {
+  std::vector<std::string> uris = inputs_;
+  uris.insert(uris.end(), mate_inputs_.begin(), mate_inputs_.end());
+  for (const auto& uri : uris) {
+    if (FQFile::is_stream(uri))
+      throw std::runtime_error(
+          "Error ingesting; cannot scan the read lengths of '" + uri +
+          "', a stream that can only be read once.");
+  }
+
+  int64_t read_length = -1;
+  Buffer chunk;
+  FQFile::FQRecordView rec;
+  for (const auto& uri : uris) {
+    FQFile fq;
+    fq.set_memory_budget(args_.memory_budget_mb);
+    fq.set_num_threads(args_.num_threads);
+    fq.open(uri);
+    while (fq.next_chunk(&chunk)) {
+      const char* p = chunk.data<char>();
+      const char* end = p + chunk.size();
+      while (p < end) {
+        p = FQFile::parse_record_view(p, end, &rec);
+        const int64_t len = rec.sequence.size;
+        if (read_length < 0)
+          read_length = len;
+        else if (len != read_length)
+          return 0;
+      }
+      fq.release_chunk(chunk);
+    }
+  }
+
+  // Empty reads and overly long reads are stored as var-length cells.
+  if (read_length <= 0 || read_length > std::numeric_limits<uint32_t>::max())
+    return 0;
+  return uint32_t(read_length);
+}
+
+uint64_t Writer::count_records(
+    const std::string& uri,
+    uint64_t memory_budget_bytes,
+    unsigned num_threads) const {
   FQFile fq;
-  fq.open(args_.input_uri);
+  fq.set_memory_budget_bytes(memory_budget_bytes);
+  fq.open(uri);
+  if (fq.is_bgzf())
+    fq.set_num_threads(num_threads);
 
-  std::vector<char> header;
-  std::vector<uint64_t> header_offsets;
-  std::vector<char> sequence;
-  std::vector<char> description;
-  std::vector<uint64_t> description_offsets;
-  std::vector<uint8_t> quality;
+  // Chunks hold whole records, so text after the last newline of a chunk is
+  // the last record of the file, missing its trailing newline.
+  std::vector<const char*> newlines(64 * 1024);
+  uint64_t num_lines = 0;
+  Buffer chunk;
+  while (fq.next_chunk(&chunk)) {
+    const char* p = chunk.data<char>();
+    const char* end = p + chunk.size();
+    while (p < end) {
+      const size_t n =
+          scan::find_newlines(p, end, newlines.size(), newlines.data());
+      num_lines += n > 0 ? n : 1;
+      p = n > 0 ? newlines[n - 1] + 1 : end;
+    }
+    fq.release_chunk(chunk);
+  }
+  return num_lines / 4;
+}
 
+std::vector<FQFile::FQRecord> Writer::sample_records() const {
+  const size_t num_samples = 1000;
+  std::vector<std::string> uris = inputs_;
+  uris.insert(uris.end(), mate_inputs_.begin(), mate_inputs_.end());
+  std::vector<FQFile::FQRecord> samples;
   FQFile::FQRecord rec;
-  uint64_t header_off = 0, desc_off = 0;
-  while (fq.next_record(&rec)) {
-    header_offsets.push_back(header_off);
-    header.insert(header.end(), rec.header.begin(), rec.header.end());
-    header_off += rec.header.size();
+  for (const auto& uri : uris) {
+    if (FQFile::is_stream(uri))
+      continue;
+    FQFile fq;
+    fq.set_memory_budget_bytes(4 * 1024 * 1024);
+    fq.open(uri);
+    for (size_t i = 0; i < num_samples && fq.next_record(&rec); i++)
+      samples.push_back(rec);
+  }
+  return samples;
+}
 
-    sequence.insert(sequence.end(), rec.sequence.begin(), rec.sequence.end());
+std::vector<header_tokens::Field> Writer::infer_header_template(
+    const std::vector<FQFile::FQRecord>& samples) const {
+  std::vector<std::string> headers;
+  headers.reserve(samples.size());
+  for (const auto& rec : samples)
+    headers.push_back(rec.header);
+  return header_tokens::infer(headers);
+}
 
-    if (rec.description.empty())
-      rec.description = "-";
-    description_offsets.push_back(desc_off);
-    description.insert(
-        description.end(), rec.description.begin(), rec.description.end());
-    desc_off += rec.description.size();
+uint64_t Writer::choose_tile_extent(
+    const std::vector<FQFile::FQRecord>& samples) const {
+  if (samples.empty())
+    return 100000;
 
-    quality.insert(quality.end(), rec.qualities.begin(), rec.qualities.end());
+  // Qualities take one byte per base, and are the largest attribute but for
+  // short reads with long headers.
+  uint64_t header_bytes = 0, quality_bytes = 0;
+  for (const auto& rec : samples) {
+    header_bytes += rec.header.size();
+    quality_bytes += std::max<size_t>(rec.qualities.size(), 1);
   }
+  const uint64_t record_bytes = utils::ceil(
+      std::max(header_bytes, quality_bytes), uint64_t(samples.size()));
 
-  tiledb::Array array(*ctx_, args_.uri, TILEDB_WRITE);
-  tiledb::Query query(*ctx_, array);
-  query.set_subarray(std::array<uint64_t, 2>{0, header_offsets.size() - 1});
-  query.set_buffer("header", header_offsets, header);
-  query.set_buffer("sequence", sequence);
-  query.set_buffer("description", description_offsets, description);
-  query.set_buffer("quality", quality);
-  query.submit();
+  const uint64_t budget_bytes =
+      uint64_t(std::max(args_.memory_budget_mb, 1u)) * 1024 * 1024;
+  const uint64_t tile_bytes = std::min(
+      uint64_t(std::max(args_.tile_size_mb, 1u)) * 1024 * 1024,
+      budget_bytes / 16);
+  const uint64_t extent = std::max<uint64_t>(tile_bytes / record_bytes, 1);
+  if (!format_.paired)
+    return extent;
+  return std::max<uint64_t>(extent - extent % 2, 2);
 }
 
-void Writer::create_array() {
-  const uint64_t tile_extent = 100000;
+void Writer::create_array(const StorageFormat& format) {
+  const uint64_t tile_extent = format.tile_extent;
   const uint64_t dom_min = 0, dom_max = std::numeric_limits<uint64_t>::max() -
                                         tile_extent - 1;
   auto dim =
@@ -97,21 +853,56 @@ void Writer::create_array() {
   tiledb::Domain dom(*ctx_);
   dom.add_dimension(dim);
 
-  const int cell_val_num = 100;
-
   auto header = tiledb::Attribute::create<std::vector<char>>(
-      *ctx_, "header", make_filters({TILEDB_FILTER_BZIP2}));
-  auto sequence = tiledb::Attribute::create<char>(
-      *ctx_, "sequence", make_filters({TILEDB_FILTER_BZIP2}));
-  sequence.set_cell_val_num(cell_val_num);
-  auto description = tiledb::Attribute::create<std::vector<char>>(
-      *ctx_, "description", make_filters({TILEDB_FILTER_BZIP2}));
+      *ctx_, "header", make_filters(format, "header"));
+  // Packed sequences are var-length even for fixed-length reads, because of
+  // the exceptions.
+  const bool packed = format.sequence_encoding == SequenceEncoding::TwoBit;
+  const unsigned cell_val_num = format.fixed_read_length > 0 ?
+                                    format.fixed_read_length :
+                                    TILEDB_VAR_NUM;
+  tiledb::Attribute sequence(
+      *ctx_, "sequence", packed ? TILEDB_UINT8 : TILEDB_CHAR);
+  sequence.set_filter_list(make_filters(format, "sequence"));
+  sequence.set_cell_val_num(packed ? TILEDB_VAR_NUM : cell_val_num);
+  // Description kinds are nearly all the same, and compress to little.
+  tiledb::Attribute description =
+      format.description_encoding == DescriptionEncoding::Kinds ?
+          tiledb::Attribute::create<uint8_t>(
+              *ctx_,
+              descriptions::KIND_ATTRIBUTE,
+              make_filters(format, "description")) :
+          tiledb::Attribute::create<std::vector<char>>(
+              *ctx_, "description", make_filters(format, "description"));
   auto quality = tiledb::Attribute::create<uint8_t>(
-      *ctx_, "quality", make_filters({TILEDB_FILTER_BZIP2}));
+      *ctx_, "quality", make_filters(format, "quality"));
   quality.set_cell_val_num(cell_val_num);
 
   tiledb::ArraySchema schema(*ctx_, TILEDB_DENSE);
   schema.set_domain(dom);
+
+  // Integer header fields are mostly counters and coordinates, which change
+  // little from read to read, so they are delta-encoded before compression.
+  const auto& fields = format.header_template;
+  for (size_t f = 0; f < fields.size(); f++) {
+    const std::string name = header_tokens::attribute_name(f);
+    if (fields[f].kind == header_tokens::FieldKind::Integer) {
+      const auto filters = make_filters(format, "header");
+      tiledb::FilterList delta_filters(*ctx_);
+      delta_filters.add_filter(
+          tiledb::Filter(*ctx_, TILEDB_FILTER_DOUBLE_DELTA));
+      for (uint32_t i = 0; i < filters.nfilters(); i++)
+        delta_filters.add_filter(filters.filter(i));
+      schema.add_attribute(
+          tiledb::Attribute::create<uint64_t>(*ctx_, name, delta_filters));
+    } else if (fields[f].kind == header_tokens::FieldKind::String) {
+      schema.add_attribute(tiledb::Attribute::create<std::vector<char>>(
+          *ctx_, name, make_filters(format, "header")));
+    }
+  }
+
+  if (format.filters.pipelines.count(compression::OFFSETS))
+    schema.set_offsets_filter_list(make_filters(format, compression::OFFSETS));
   schema.add_attribute(header)
       .add_attribute(sequence)
       .add_attribute(description)
@@ -120,12 +911,27 @@ void Writer::create_array() {
   tiledb::Array::create(args_.uri, schema);
 }
 
+std::vector<quality_bins::Bin> Writer::quality_bin_table() const {
+  if (args_.quality_mode == "lossless")
+    return {};
+  if (args_.quality_mode == "illumina8")
+    return quality_bins::illumina8();
+  return quality_bins::parse(args_.quality_mode);
+}
+
+compression::Config Writer::compression_config() const {
+  auto config = compression::preset(args_.compression);
+  compression::apply_overrides(args_.filters, &config);
+  return config;
+}
+
 tiledb::FilterList Writer::make_filters(
-    const std::initializer_list<tiledb_filter_type_t>& list) const {
-  FilterList filters(*ctx_);
-  for (auto t : list)
-    filters.add_filter(Filter(*ctx_, t));
-  return filters;
+    const StorageFormat& format, const std::string& name) const {
+  const auto& pipelines = format.filters.pipelines;
+  auto it = pipelines.find(name);
+  if (it == pipelines.end())
+    return FilterList(*ctx_);
+  return compression::make_filter_list(*ctx_, it->second);
 }
 
 }  // namespace fq
@@ -27,7 +27,15 @@
 #ifndef TILEDB_FASTQ_WRITER_H
 #define TILEDB_FASTQ_WRITER_H
 
+#include <string>
+#include <thread>
 #include <tiledb/tiledb>
+#include <vector>
+
+#include "utils/stats.h"
+#include "utils/storage_format.h"
+#include "write/fqfile.h"
+#include "write/record_batch.h"
 
 namespace tiledb {
 namespace fq {
@@ -39,9 +47,78 @@ namespace fq {
 /** Arguments/params for dataset ingestion. */
 struct IngestionParams {
   std::string uri;
+  /**
+   * FastQ input: a file, a directory (or prefix) whose FastQ files are all
+   * ingested, a glob pattern matching file names in a directory, or a stream
+   * such as "-" for stdin (see FQFile::is_stream).
+   */
   std::string input_uri;
+  /** More inputs, each resolved as input_uri. */
+  std::vector<std::string> more_input_uris;
+  /**
+   * FastQ input of the second mates (R2) of paired-end reads, resolved as
+   * input_uri. The files are paired with the input files in sorted order.
+   * Empty for single-end reads.
+   */
+  std::string mate_input_uri;
+  /**
+   * Number of input files ingested concurrently, sharing the threads and the
+   * memory budget. 0 to ingest up to one file per thread. Files are stored
+   * in input order, each as a contiguous range of records; with more than
+   * one worker, the records of every file are counted first, which reads
+   * the input twice.
+   */
+  unsigned num_file_workers = 0;
+  /** Print progress lines and the statistics of the ingestion. */
   bool verbose = false;
+  /** File to write the statistics of the ingestion to, as JSON, if set. */
+  std::string stats_uri;
   unsigned memory_budget_mb = 2 * 1024;
+  /**
+   * Total number of threads for ingestion, split evenly between the file
+   * workers, each of which shares its threads between BGZF decompression
+   * and parsing.
+   */
+  unsigned num_threads = std::thread::hardware_concurrency();
+  bool scan_read_length = false;
+  /**
+   * Number of records per tile, or 0 to size the tiles from the first
+   * records of the input, see choose_tile_extent(). Must be even for
+   * paired-end reads.
+   */
+  uint64_t tile_extent = 0;
+  /** Target size of the tiles chosen automatically, uncompressed. */
+  unsigned tile_size_mb = 8;
+  bool pack_sequences = true;
+  /** "lossless", "illumina8", or a bin table (see quality_bins::parse). */
+  std::string quality_mode = "lossless";
+  /** Build an index of the read names, for looking up reads by name. */
+  bool header_index = false;
+  /**
+   * Store the fields of the headers in separate attributes, following a
+   * template inferred from the first headers of each input file (see
+   * header_tokens). Streams are not sampled.
+   */
+  bool tokenize_headers = false;
+  /**
+   * Store the descriptions as their kind (empty, same as the header, or
+   * explicit), keeping only the explicit ones, see descriptions. Otherwise
+   * every description is stored verbatim.
+   */
+  bool encode_descriptions = true;
+  /** Compression preset of the attributes, see compression::preset. */
+  std::string compression = "balanced";
+  /**
+   * Per-attribute filter pipelines overriding the preset, as comma-separated
+   * "NAME=PIPELINE" entries (see compression::apply_overrides).
+   */
+  std::string filters;
+  /**
+   * Append the records to an existing array, after its last record, as new
+   * fragments. The array keeps its storage format, so the format parameters
+   * above are ignored.
+   */
+  bool append = false;
 };
 
 /* ********************************* */
@@ -64,17 +141,143 @@ class Writer {
   /** Sets all parameters. */
   void set_all_params(const IngestionParams& args);
 
+  /**
+   * Returns the statistics of the last ingestion: bytes and records
+   * processed, time spent in each stage and waiting between stages, and peak
+   * buffer memory.
+   */
+  const Stats& stats() const;
+
  private:
   IngestionParams args_;
 
   std::unique_ptr<tiledb::Context> ctx_;
 
+  /** How the records are stored in the array. */
+  StorageFormat format_;
+
+  /** The header index array open for writing, if building the index. */
+  std::unique_ptr<tiledb::Array> index_array_;
+
+  /**
+   * The descriptions array open for writing, if the descriptions are stored
+   * as kinds.
+   */
+  std::unique_ptr<tiledb::Array> descriptions_array_;
+
+  /** Input files, and the files of their mates if paired. */
+  std::vector<std::string> inputs_;
+  std::vector<std::string> mate_inputs_;
+
+  Stats stats_;
+
   void init_tiledb();
 
-  void create_array();
+  /** Creates the array, with attributes laid out in the given format. */
+  void create_array(const StorageFormat& format);
+
+  /**
+   * Reads the storage format of the existing array to append to.
+   *
+   * @return Number of the first record to append
+   *
+   * @throws std::runtime_error if the array holds paired-end reads and the
+   *    input does not, or vice versa.
+   */
+  uint64_t open_for_append();
+
+  /**
+   * Reads through a file once to count its records.
+   *
+   * @param uri Input file, which must not be a stream
+   * @param memory_budget_bytes Memory budget for buffering the file
+   * @param num_threads Number of threads inflating BGZF input
+   * @return Number of records in the file
+   */
+  uint64_t count_records(
+      const std::string& uri,
+      uint64_t memory_budget_bytes,
+      unsigned num_threads) const;
+
+  /**
+   * Reads through the input files once to check the read lengths.
+   *
+   * @return The length of every read, or 0 if the lengths are not uniform
+   */
+  uint32_t scan_read_length() const;
+
+  /**
+   * Resolves an input URI to the sorted list of files it names, see
+   * IngestionParams::input_uri.
+   *
+   * @throws std::runtime_error if a directory or pattern matches no files.
+   */
+  std::vector<std::string> resolve_input(const std::string& uri) const;
+
+  /**
+   * Ingests all records of the given file. Decompression, parsing and
+   * writing run concurrently as stages of a pipeline. The batches are written
+   * in input order, so the file is stored as a contiguous range of records
+   * from first_record on.
+   *
+   * @param fq Input file
+   * @param mate_fq File of the second mates for paired-end reads, or null.
+   *    The mates are interleaved, and must have matching read names.
+   * @param uri URI of the input file, for error messages
+   * @param mate_uri URI of the file of the second mates, if any
+   * @param array Array open for writing
+   * @param first_record Number of the first record of the file
+   * @param num_parsers Number of parser threads
+   * @return Number of records ingested
+   *
+   * @throws std::runtime_error if the two files of a pair have different
+   *    numbers of records, or the names of two mates differ.
+   */
+  uint64_t ingest_file(
+      FQFile* fq,
+      FQFile* mate_fq,
+      const std::string& uri,
+      const std::string& mate_uri,
+      const tiledb::Array& array,
+      uint64_t first_record,
+      unsigned num_parsers);
+
+  /**
+   * Writes a batch as the records from record_start on, with its index and
+   * description entries. Batches without records are skipped.
+   */
+  void write_batch(
+      const tiledb::Array& array, uint64_t record_start, RecordBatch* batch);
+
+  /**
+   * Returns the first records of each input file that is not a stream,
+   * including the mate files.
+   */
+  std::vector<FQFile::FQRecord> sample_records() const;
+
+  /** Infers the header template from the sampled records. */
+  std::vector<header_tokens::Field> infer_header_template(
+      const std::vector<FQFile::FQRecord>& samples) const;
+
+  /**
+   * Chooses the number of records per tile, so that the tiles of the
+   * largest attribute of the sampled records are about the target tile
+   * size, and at most a sixteenth of the memory budget. The extent is
+   * rounded down to an even number for paired-end reads, so that tiles
+   * hold whole pairs. Falls back to 100000 records without samples.
+   */
+  uint64_t choose_tile_extent(
+      const std::vector<FQFile::FQRecord>& samples) const;
+
+  /** Returns the quality bin table for the quality mode parameter. */
+  std::vector<quality_bins::Bin> quality_bin_table() const;
+
+  /** Returns the filter pipelines for the compression parameters. */
+  compression::Config compression_config() const;
 
+  /** Returns the filter list of the given pipeline of the format. */
   tiledb::FilterList make_filters(
-      const std::initializer_list<tiledb_filter_type_t>& list) const;
+      const StorageFormat& format, const std::string& name) const;
 };
 
 }  // namespace fq
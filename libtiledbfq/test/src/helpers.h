@@ -0,0 +1,99 @@
+/**
+ * @file   helpers.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Helpers for reading and writing test files.
+ */
+
+#ifndef TILEDB_FASTQ_TEST_HELPERS_H
+#define TILEDB_FASTQ_TEST_HELPERS_H
+
+#include "catch.hpp"
+
+#include <zlib.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tiledb {
+namespace fq {
+namespace test {
+
+/** Returns the contents of a file, or an empty string if it is missing. */
+inline std::string read_file(const std::string& path) {
+  std::ifstream is(path, std::ios::binary);
+  std::stringstream ss;
+  ss << is.rdbuf();
+  return ss.str();
+}
+
+/** Returns the decompressed contents of a gzip file. */
+inline std::string read_gzip_file(const std::string& path) {
+  gzFile gz = gzopen(path.c_str(), "rb");
+  REQUIRE(gz != nullptr);
+  std::string result;
+  std::vector<char> buff(1024 * 1024);
+  int n;
+  while ((n = gzread(gz, buff.data(), (unsigned)buff.size())) > 0)
+    result.append(buff.data(), n);
+  REQUIRE(n == 0);
+  gzclose(gz);
+  return result;
+}
+
+/**
+ * Writes text to a gzip file. In append mode, the text is added as a new
+ * gzip member.
+ */
+inline void write_gzip_file(
+    const std::string& path, const std::string& text, bool append = false) {
+  gzFile gz = gzopen(path.c_str(), append ? "ab" : "wb");
+  REQUIRE(gz != nullptr);
+  REQUIRE(gzwrite(gz, text.data(), (unsigned)text.size()) == (int)text.size());
+  REQUIRE(gzclose(gz) == Z_OK);
+}
+
+/** Returns records first to last (inclusive) of FastQ text. */
+inline std::string record_range(
+    const std::string& text, size_t first, size_t last) {
+  size_t begin = 0, line = 0;
+  for (; line < 4 * first; line++)
+    begin = text.find('\n', begin) + 1;
+  size_t end = begin;
+  for (; line < 4 * (last + 1) && end < text.size(); line++)
+    end = text.find('\n', end) + 1;
+  return text.substr(begin, end - begin);
+}
+
+}  // namespace test
+}  // namespace fq
+}  // namespace tiledb
+
+#endif  // TILEDB_FASTQ_TEST_HELPERS_H
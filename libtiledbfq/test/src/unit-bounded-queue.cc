@@ -0,0 +1,87 @@
+/**
+ * @file   unit-bounded-queue.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for BoundedQueue.
+ */
+
+#include "catch.hpp"
+
+#include "utils/bounded_queue.h"
+
+#include <thread>
+#include <vector>
+
+using namespace tiledb::fq;
+
+TEST_CASE(
+    "TileDB-FastQ: Test bounded queue", "[tiledbfq][bounded-queue]") {
+  BoundedQueue<int> queue(3);
+
+  // Many more values than the capacity pass through in FIFO order.
+  bool pushed = true;
+  std::thread producer([&queue, &pushed]() {
+    for (int i = 0; i < 1000; i++)
+      pushed = queue.push(i) && pushed;
+    queue.close();
+  });
+
+  std::vector<int> values;
+  int v;
+  while (queue.pop(&v))
+    values.push_back(v);
+  producer.join();
+
+  REQUIRE(pushed);
+  REQUIRE(values.size() == 1000);
+  for (int i = 0; i < 1000; i++)
+    REQUIRE(values[i] == i);
+
+  // A closed queue refuses new values.
+  REQUIRE(!queue.push(1));
+  REQUIRE(!queue.pop(&v));
+}
+
+TEST_CASE(
+    "TileDB-FastQ: Test bounded queue close", "[tiledbfq][bounded-queue]") {
+  BoundedQueue<int> queue(1);
+  REQUIRE(queue.push(1));
+
+  // Closing wakes up a producer blocked on a full queue.
+  bool pushed = true;
+  std::thread producer([&queue, &pushed]() { pushed = queue.push(2); });
+  queue.close();
+  producer.join();
+  REQUIRE(!pushed);
+
+  // Values pushed before closing can still be drained.
+  int v;
+  REQUIRE(queue.pop(&v));
+  REQUIRE(v == 1);
+  REQUIRE(!queue.pop(&v));
+}
@@ -0,0 +1,111 @@
+/**
+ * @file   unit-compression.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the filter pipelines of the attributes.
+ */
+
+#include "catch.hpp"
+
+#include "utils/compression.h"
+
+#include <stdexcept>
+
+using namespace tiledb::fq;
+
+TEST_CASE("TileDB-FastQ: Test filter pipelines", "[tiledbfq][compression]") {
+  SECTION("- Parse") {
+    auto pipeline = compression::parse_pipeline("double_delta+zstd:19");
+    REQUIRE(pipeline.size() == 2);
+    REQUIRE(pipeline[0].type == TILEDB_FILTER_DOUBLE_DELTA);
+    REQUIRE(pipeline[0].level == -1);
+    REQUIRE(pipeline[1].type == TILEDB_FILTER_ZSTD);
+    REQUIRE(pipeline[1].level == 19);
+    REQUIRE(compression::to_string(pipeline) == "double_delta+zstd:19");
+    REQUIRE(compression::parse_pipeline("none").empty());
+    REQUIRE(compression::to_string(compression::Pipeline()) == "none");
+    REQUIRE(
+        compression::to_string(
+            compression::parse_pipeline("bitshuffle+lz4")) ==
+        "bitshuffle+lz4");
+  }
+
+  SECTION("- Invalid") {
+    for (const char* spec :
+         {"",
+          "zstd+",
+          "snappy",
+          "zstd:x",
+          "zstd:3:1",
+          "bitshuffle:2",
+          "rle:3"})
+      REQUIRE_THROWS_AS(
+          compression::parse_pipeline(spec), std::runtime_error);
+  }
+
+  SECTION("- Presets") {
+    for (const auto& name : compression::preset_names()) {
+      auto config = compression::preset(name);
+      REQUIRE(config.preset == name);
+      for (const char* attr : {"header", "sequence", "description", "quality"})
+        REQUIRE(config.pipelines.count(attr) == 1);
+    }
+    REQUIRE(
+        compression::to_string(compression::preset("archive")) ==
+        "description=zstd:19,header=zstd:19,offsets=double_delta+zstd:19,"
+        "quality=bzip2:9,sequence=zstd:19");
+    REQUIRE(compression::preset("bzip2").pipelines.count("offsets") == 0);
+    REQUIRE_THROWS_AS(compression::preset("fastest"), std::runtime_error);
+  }
+
+  SECTION("- Overrides") {
+    auto config = compression::preset("balanced");
+    compression::apply_overrides("quality=lz4,offsets=none", &config);
+    REQUIRE(compression::to_string(config.pipelines["quality"]) == "lz4");
+    REQUIRE(config.pipelines["offsets"].empty());
+    REQUIRE(compression::to_string(config.pipelines["header"]) == "zstd:3");
+    REQUIRE_THROWS_AS(
+        compression::apply_overrides("comment=lz4", &config),
+        std::runtime_error);
+    REQUIRE_THROWS_AS(
+        compression::apply_overrides("quality", &config), std::runtime_error);
+  }
+
+  SECTION("- Filter list") {
+    tiledb::Context ctx;
+    auto filters = compression::make_filter_list(
+        ctx, compression::parse_pipeline("byteshuffle+gzip:6"));
+    REQUIRE(filters.nfilters() == 2);
+    REQUIRE(filters.filter(0).filter_type() == TILEDB_FILTER_BYTESHUFFLE);
+    REQUIRE(filters.filter(1).filter_type() == TILEDB_FILTER_GZIP);
+    int32_t level;
+    filters.filter(1).get_option(TILEDB_COMPRESSION_LEVEL, &level);
+    REQUIRE(level == 6);
+  }
+}
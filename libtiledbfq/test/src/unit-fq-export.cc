@@ -0,0 +1,736 @@
+/**
+ * @file   unit-fq-export.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for FastQ export.
+ */
+
+#include "catch.hpp"
+#include "helpers.h"
+
+#include "read/reader.h"
+#include "utils/bgzf.h"
+#include "utils/descriptions.h"
+#include "write/writer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace tiledb::fq;
+using namespace tiledb::fq::test;
+
+static const std::string input_dir = TILEDB_FASTQ_TEST_INPUT_DIR;
+
+TEST_CASE("TileDB-FastQ: Test export round trip", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export.fastq.gz";
+  std::string output_path = "test_export.fastq";
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  std::string text;
+  SECTION("- Mixed records") {
+    text =
+        "@r1 first\nACGTNNacgt\n+r1 first\nIIIIIIIIII\n"
+        "@r2\n\n+\n\n"
+        "@r3\nRYKM\n+\n!#~5\n";
+    SECTION("- Packed") {
+      store_params.pack_sequences = true;
+    }
+    SECTION("- Raw") {
+      store_params.pack_sequences = false;
+    }
+  }
+  SECTION("- Empty headers and descriptions") {
+    // Stored with padding, as empty cells are not allowed; fields of dashes
+    // must not be mistaken for the padding.
+    text =
+        "@\nACGT\n+\nIIII\n"
+        "@-\nAC\n+-\nII\n"
+        "@r3 x\nA\n+--\n#\n"
+        "@--\n\n+\n\n"
+        "@r5\nGG\n+r5\n!!\n";
+    SECTION("- Raw") {
+    }
+    SECTION("- Encoded descriptions") {
+      store_params.encode_descriptions = true;
+    }
+    SECTION("- Tokenized headers") {
+      store_params.tokenize_headers = true;
+    }
+    SECTION("- Header index") {
+      store_params.header_index = true;
+    }
+  }
+  SECTION("- Fixed-length reads") {
+    text = "@a\nACGT\n+\nABCD\n@b\nNNNN\n+b\n!!!!\n";
+    store_params.scan_read_length = true;
+    SECTION("- Packed") {
+      store_params.pack_sequences = true;
+    }
+    SECTION("- Raw") {
+      store_params.pack_sequences = false;
+    }
+  }
+  write_gzip_file(input_path, text);
+
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  Reader reader;
+  reader.set_all_params(export_params);
+  reader.export_fastq();
+  REQUIRE(read_file(output_path) == text);
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test batched export", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string output_path = "test_export.fastq";
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_dir + "/SRR062641.filt.fastq.gz";
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  // A small budget splits the export into many batches.
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.memory_budget_mb = 1;
+  SECTION("- Single formatter") {
+    export_params.num_threads = 1;
+  }
+  SECTION("- Multiple formatters") {
+    export_params.num_threads = 4;
+  }
+  Reader reader;
+  reader.set_all_params(export_params);
+  reader.export_fastq();
+  REQUIRE(read_file(output_path) == read_gzip_file(store_params.input_uri));
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test export to stdout", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_dir + "/SRR062641.filt.fastq.gz";
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.memory_budget_mb = 1;
+  export_params.num_threads = 4;
+  SECTION("- Default") {
+  }
+  SECTION("- Dash") {
+    export_params.output_uri = "-";
+  }
+
+  // Capture stdout.
+  std::ostringstream captured;
+  std::streambuf* stdout_buf = std::cout.rdbuf(captured.rdbuf());
+  try {
+    Reader reader;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+  } catch (...) {
+    std::cout.rdbuf(stdout_buf);
+    throw;
+  }
+  std::cout.rdbuf(stdout_buf);
+  REQUIRE(captured.str() == read_gzip_file(store_params.input_uri));
+
+  vfs.remove_dir(dataset_uri);
+}
+
+TEST_CASE("TileDB-FastQ: Test compressed export", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string output_path = "test_export.fastq.gz";
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_dir + "/SRR062641.filt.fastq.gz";
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.memory_budget_mb = 1;
+  SECTION("- Single formatter") {
+    export_params.num_threads = 1;
+  }
+  SECTION("- Multiple formatters") {
+    export_params.num_threads = 4;
+  }
+  Reader reader;
+  reader.set_all_params(export_params);
+  reader.export_fastq();
+  REQUIRE(
+      read_gzip_file(output_path) == read_gzip_file(store_params.input_uri));
+
+  // The output is a series of BGZF blocks ending with the EOF block.
+  std::string compressed = read_file(output_path);
+  const uint8_t* data = (const uint8_t*)compressed.data();
+  size_t offset = 0, num_blocks = 0, block_size, data_size;
+  while (bgzf::read_block(
+      data + offset, compressed.size() - offset, &block_size, &data_size)) {
+    REQUIRE(data_size <= bgzf::MAX_BLOCK_DATA_SIZE);
+    offset += block_size;
+    num_blocks++;
+  }
+  REQUIRE(offset == compressed.size());
+  REQUIRE(num_blocks > 1);
+  REQUIRE(
+      compressed.substr(compressed.size() - bgzf::EOF_BLOCK_SIZE) ==
+      std::string((const char*)bgzf::EOF_BLOCK, bgzf::EOF_BLOCK_SIZE));
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test export record range", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string output_path = "test_export.fastq";
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_dir + "/SRR062641.filt.fastq.gz";
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+  const std::string text = read_gzip_file(store_params.input_uri);
+  const uint64_t num_records = std::count(text.begin(), text.end(), '\n') / 4;
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.memory_budget_mb = 1;
+  Reader reader;
+
+  SECTION("- Single record") {
+    export_params.record_start = 5;
+    export_params.record_end = 5;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == record_range(text, 5, 5));
+  }
+
+  SECTION("- Across batches") {
+    const uint64_t mid = num_records / 2;
+    export_params.record_start = mid - 1000;
+    export_params.record_end = mid + 1000;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(
+        read_file(output_path) == record_range(text, mid - 1000, mid + 1000));
+  }
+
+  SECTION("- Past the last record") {
+    export_params.record_start = num_records - 10;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(
+        read_file(output_path) ==
+        record_range(text, num_records - 10, num_records - 1));
+
+    export_params.record_start = num_records;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path).empty());
+  }
+
+  SECTION("- Invalid range") {
+    export_params.record_start = 10;
+    export_params.record_end = 9;
+    reader.set_all_params(export_params);
+    REQUIRE_THROWS(reader.export_fastq());
+  }
+
+  vfs.remove_dir(dataset_uri);
+  if (vfs.is_file(output_path))
+    vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test paired-end round trip", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export_R1.fastq.gz";
+  std::string mate_input_path = "test_export_R2.fastq.gz";
+  std::string output_path = "test_export_R1.fastq";
+  std::string mate_output_path = "test_export_R2.fastq";
+
+  // Enough pairs for many batches and chunks at a 1MB budget.
+  std::string r1, r2, interleaved;
+  for (unsigned i = 0; i < 20000; i++) {
+    const std::string name = "@pair" + std::to_string(i);
+    const std::string read1 = name + "/1\nACGTACGTAC\n+\nIIIIIIIIII\n";
+    const std::string read2 = name + "/2 x\nTTGCA\n+\n!!!!!\n";
+    r1 += read1;
+    r2 += read2;
+    interleaved += read1 + read2;
+  }
+  write_gzip_file(input_path, r1);
+  write_gzip_file(mate_input_path, r2);
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.mate_input_uri = mate_input_path;
+  store_params.header_index = true;
+  store_params.memory_budget_mb = 1;
+  store_params.num_threads = 2;
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.memory_budget_mb = 1;
+  export_params.num_threads = 2;
+  Reader reader;
+
+  SECTION("- Interleaved") {
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == interleaved);
+  }
+
+  SECTION("- Split") {
+    export_params.mate_output_uri = mate_output_path;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == r1);
+    REQUIRE(read_file(mate_output_path) == r2);
+  }
+
+  SECTION("- Split range") {
+    // Ranges are widened to whole pairs.
+    export_params.mate_output_uri = mate_output_path;
+    export_params.record_start = 3;
+    export_params.record_end = 4;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == record_range(r1, 1, 2));
+    REQUIRE(read_file(mate_output_path) == record_range(r2, 1, 2));
+  }
+
+  SECTION("- Split with compressed mates") {
+    // Each output file is compressed if its name ends in ".gz".
+    const std::string gz_mate_output_path = "test_export_out_R2.fastq.gz";
+    export_params.mate_output_uri = gz_mate_output_path;
+    std::string expected_r1 = r1, expected_r2 = r2;
+    SECTION("- All records") {
+    }
+    SECTION("- By name") {
+      const std::string names_path = "test_export_names.txt";
+      std::ofstream(names_path) << "pair7/1\npair19998/2\n";
+      export_params.names_uri = names_path;
+      expected_r1 = record_range(r1, 7, 7) + record_range(r1, 19998, 19998);
+      expected_r2 = record_range(r2, 7, 7) + record_range(r2, 19998, 19998);
+    }
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == expected_r1);
+    const std::string compressed = read_file(gz_mate_output_path);
+    REQUIRE(compressed.size() > bgzf::EOF_BLOCK_SIZE);
+    REQUIRE(
+        compressed.substr(compressed.size() - bgzf::EOF_BLOCK_SIZE) ==
+        std::string((const char*)bgzf::EOF_BLOCK, bgzf::EOF_BLOCK_SIZE));
+    REQUIRE(read_gzip_file(gz_mate_output_path) == expected_r2);
+    vfs.remove_file(gz_mate_output_path);
+    if (!export_params.names_uri.empty())
+      vfs.remove_file(export_params.names_uri);
+  }
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_input_path);
+  vfs.remove_file(output_path);
+  if (vfs.is_file(mate_output_path))
+    vfs.remove_file(mate_output_path);
+}
+
+TEST_CASE(
+    "TileDB-FastQ: Test paired-end input without final newlines",
+    "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export_R1.fastq.gz";
+  std::string mate_input_path = "test_export_R2.fastq.gz";
+  std::string output_path = "test_export_R1.fastq";
+  std::string mate_output_path = "test_export_R2.fastq";
+
+  // The last record of either file may be missing its trailing newline.
+  const std::string r1 = "@a/1\nAC\n+\nII\n@b/1\nGT\n+\n!!\n";
+  const std::string r2 = "@a/2\nTT\n+\nII\n@b/2\nCA\n+\n##\n";
+  std::string input = r1, mate_input = r2;
+  SECTION("- First file") {
+    input.pop_back();
+  }
+  SECTION("- Mate file") {
+    mate_input.pop_back();
+  }
+  SECTION("- Both files") {
+    input.pop_back();
+    mate_input.pop_back();
+  }
+  write_gzip_file(input_path, input);
+  write_gzip_file(mate_input_path, mate_input);
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.mate_input_uri = mate_input_path;
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.mate_output_uri = mate_output_path;
+  Reader reader;
+  reader.set_all_params(export_params);
+  reader.export_fastq();
+  REQUIRE(read_file(output_path) == r1);
+  REQUIRE(read_file(mate_output_path) == r2);
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_input_path);
+  vfs.remove_file(output_path);
+  vfs.remove_file(mate_output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test paired-end mismatches", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export_R1.fastq.gz";
+  std::string mate_input_path = "test_export_R2.fastq.gz";
+
+  write_gzip_file(input_path, "@a/1\nAC\n+\nII\n@b/1\nAC\n+\nII\n");
+  SECTION("- Names") {
+    write_gzip_file(mate_input_path, "@a/2\nAC\n+\nII\n@c/2\nAC\n+\nII\n");
+  }
+  SECTION("- Counts") {
+    write_gzip_file(mate_input_path, "@a/2\nAC\n+\nII\n");
+  }
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.mate_input_uri = mate_input_path;
+  Writer writer;
+  writer.set_all_params(store_params);
+  REQUIRE_THROWS(writer.ingest());
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_input_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test export binned qualities", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export.fastq.gz";
+  std::string output_path = "test_export.fastq";
+  write_gzip_file(input_path, "@r1\nACGTA\n+\n!+5?J\n");
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.quality_mode = "illumina8";
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  Reader reader;
+  reader.set_all_params(export_params);
+  reader.export_fastq();
+  // Scores 0, 10, 20, 30, 41 map to 2, 15, 22, 33, 40.
+  REQUIRE(read_file(output_path) == "@r1\nACGTA\n+\n#07BI\n");
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test tokenized headers", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_export_R1.fastq.gz";
+  std::string mate_input_path = "test_export_R2.fastq.gz";
+  std::string output_path = "test_export.fastq";
+
+  // Enough pairs for many batches at a 1MB budget, with a few headers that
+  // do not match the template.
+  std::string r1, r2, interleaved;
+  for (unsigned i = 0; i < 20000; i++) {
+    const std::string coords = "1:" + std::to_string(1101 + i / 100 % 4) + ":" +
+                               std::to_string(1000 + i % 3000) + ":" +
+                               std::to_string(2000 + i * 7);
+    std::string name = "@A00123:8:H7KXX:" + coords;
+    if (i % 997 == 0)
+      name = "@other" + std::to_string(i);
+    const std::string index = i % 2 ? "ACGT" : "TTGA";
+    const std::string read1 =
+        name + " 1:N:0:" + index + "\nACGTACGTAC\n+\nIIIIIIIIII\n";
+    const std::string read2 = name + " 2:N:0:" + index + "\nTTGCA\n+\n!!!!!\n";
+    r1 += read1;
+    r2 += read2;
+    interleaved += read1 + read2;
+  }
+  write_gzip_file(input_path, r1);
+  write_gzip_file(mate_input_path, r2);
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.mate_input_uri = mate_input_path;
+  store_params.tokenize_headers = true;
+  store_params.header_index = true;
+  store_params.memory_budget_mb = 1;
+  store_params.num_threads = 2;
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  REQUIRE(
+      header_tokens::to_string(format.header_template) ==
+      "cA00123:c8:cH7KXX:c1:i:i:i i:cN:c0:s");
+  REQUIRE(array.schema().has_attribute("header_5"));
+  REQUIRE(array.schema().has_attribute("header_10"));
+  REQUIRE(!array.schema().has_attribute("header_0"));
+  array.close();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  export_params.memory_budget_mb = 1;
+  export_params.num_threads = 2;
+  Reader reader;
+
+  SECTION("- All records") {
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == interleaved);
+  }
+
+  SECTION("- By name") {
+    const std::string names_path = "test_export_names.txt";
+    std::ofstream(names_path) << "A00123:8:H7KXX:1:1101:1003:2021\nother997\n";
+    export_params.names_uri = names_path;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(
+        read_file(output_path) ==
+        record_range(interleaved, 6, 7) +
+            record_range(interleaved, 1994, 1995));
+    vfs.remove_file(names_path);
+  }
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_input_path);
+  vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test encoded descriptions", "[tiledbfq][export]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  std::string input_path = "test_export_R1.fastq.gz";
+  std::string mate_input_path = "test_export_R2.fastq.gz";
+  std::string output_path = "test_export_R1.fastq";
+  std::string mate_output_path = "test_export_R2.fastq";
+  std::string names_path = "test_export_names.txt";
+
+  // Enough pairs for many batches at a 1MB budget, with every kind of
+  // description, and a few explicit ones.
+  std::string r1, r2, interleaved;
+  for (unsigned i = 0; i < 20000; i++) {
+    const std::string name = "pair" + std::to_string(i);
+    std::string desc1 = i % 3 == 0 ? "" : name + "/1";
+    std::string desc2 = i % 2 == 0 ? "" : name + "/2";
+    if (i % 1013 == 0)
+      desc1 = "note " + std::to_string(i);
+    if (i % 771 == 5)
+      desc2 = name;
+    const std::string read1 =
+        "@" + name + "/1\nACGTACGTAC\n+" + desc1 + "\nIIIIIIIIII\n";
+    const std::string read2 = "@" + name + "/2\nTTGCA\n+" + desc2 + "\n!!!!!\n";
+    r1 += read1;
+    r2 += read2;
+    interleaved += read1 + read2;
+  }
+  write_gzip_file(input_path, r1);
+  write_gzip_file(mate_input_path, r2);
+  std::ofstream(names_path) << "pair0/1\npair1013/1\npair776/2\n";
+
+  for (bool encoded : {true, false}) {
+    if (vfs.is_dir(dataset_uri))
+      vfs.remove_dir(dataset_uri);
+    IngestionParams store_params;
+    store_params.uri = dataset_uri;
+    store_params.input_uri = input_path;
+    store_params.mate_input_uri = mate_input_path;
+    store_params.header_index = true;
+    store_params.encode_descriptions = encoded;
+    store_params.memory_budget_mb = 1;
+    store_params.num_threads = 2;
+    Writer writer;
+    writer.set_all_params(store_params);
+    writer.ingest();
+
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    format.get_metadata(&array);
+    REQUIRE(
+        format.description_encoding ==
+        (encoded ? DescriptionEncoding::Kinds : DescriptionEncoding::Raw));
+    REQUIRE(array.schema().has_attribute("description") == !encoded);
+    REQUIRE(
+        array.schema().has_attribute(descriptions::KIND_ATTRIBUTE) ==
+        encoded);
+    array.close();
+    REQUIRE(vfs.is_dir(descriptions::array_uri(dataset_uri)) == encoded);
+
+    ExportParams export_params;
+    export_params.uri = dataset_uri;
+    export_params.output_uri = output_path;
+    export_params.memory_budget_mb = 1;
+    export_params.num_threads = 2;
+    Reader reader;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == interleaved);
+
+    // The explicit descriptions of scattered records.
+    export_params.names_uri = names_path;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(
+        read_file(output_path) == record_range(interleaved, 0, 0) +
+                                      record_range(interleaved, 1553, 1553) +
+                                      record_range(interleaved, 2026, 2026));
+
+    // Appended records keep the encoding of the array.
+    store_params.append = true;
+    store_params.encode_descriptions = !encoded;
+    writer.set_all_params(store_params);
+    writer.ingest();
+    export_params.names_uri = "";
+    export_params.mate_output_uri = mate_output_path;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == r1 + r1);
+    REQUIRE(read_file(mate_output_path) == r2 + r2);
+  }
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_input_path);
+  vfs.remove_file(output_path);
+  vfs.remove_file(mate_output_path);
+  vfs.remove_file(names_path);
+}
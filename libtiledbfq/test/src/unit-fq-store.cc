@@ -31,7 +31,11 @@
  */
 
 #include "catch.hpp"
+#include "helpers.h"
 
+#include "utils/quality_bins.h"
+#include "utils/sequence_codec.h"
+#include "write/fqfile.h"
 #include "write/writer.h"
 
 #include <cstring>
@@ -39,6 +43,7 @@
 #include <iostream>
 
 using namespace tiledb::fq;
+using namespace tiledb::fq::test;
 
 static const std::string input_dir = TILEDB_FASTQ_TEST_INPUT_DIR;
 
@@ -59,4 +64,661 @@ TEST_CASE("TileDB-FastQ: Test create", "[tiledbfq][ingest]") {
 
   if (vfs.is_dir(dataset_uri))
     vfs.remove_dir(dataset_uri);
-}
\ No newline at end of file
+}
+
+TEST_CASE("TileDB-FastQ: Test batched ingestion", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+
+  // A small budget splits the input into many fragments.
+  IngestionParams params;
+  params.input_uri = input_dir + "/SRR062641.filt.fastq.gz";
+  params.uri = dataset_uri;
+  params.memory_budget_mb = 16;
+  SECTION("- Single parser") {
+    params.num_threads = 1;
+  }
+  SECTION("- Multiple parsers") {
+    params.num_threads = 4;
+  }
+  SECTION("- Uncompressed input") {
+    // Uncompressed local files are parsed in place from a mapping.
+    params.input_uri = "test_batched.fastq";
+    params.num_threads = 4;
+    std::ofstream(params.input_uri, std::ios::binary)
+        << read_gzip_file(input_dir + "/SRR062641.filt.fastq.gz");
+  }
+  Writer writer;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  std::vector<std::string> headers;
+  FQFile fq;
+  fq.open(params.input_uri);
+  FQFile::FQRecord rec;
+  while (fq.next_record(&rec))
+    headers.push_back(rec.header);
+
+  const uint64_t num_records = headers.size();
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  auto non_empty = array.non_empty_domain<uint64_t>();
+  REQUIRE(non_empty.size() == 1);
+  REQUIRE(non_empty[0].second.first == 0);
+  REQUIRE(non_empty[0].second.second == num_records - 1);
+
+  std::vector<uint64_t> offsets(num_records);
+  std::vector<char> data(num_records * 100);
+  tiledb::Query query(ctx, array);
+  query.set_subarray(std::vector<uint64_t>{0, num_records - 1});
+  query.set_buffer("header", offsets, data);
+  REQUIRE(query.submit() == tiledb::Query::Status::COMPLETE);
+  auto result_el = query.result_buffer_elements();
+  REQUIRE(result_el["header"].first == num_records);
+  for (uint64_t i = 0; i < num_records; i++) {
+    uint64_t end =
+        i + 1 < num_records ? offsets[i + 1] : result_el["header"].second;
+    REQUIRE(std::string(&data[offsets[i]], end - offsets[i]) == headers[i]);
+  }
+  array.close();
+
+  // Every record passes through each stage once.
+  const std::string json = writer.stats().to_json();
+  const std::string count = ": " + std::to_string(num_records);
+  REQUIRE(json.find("\"records_parsed\"" + count + ",") != std::string::npos);
+  REQUIRE(
+      json.find("\"records_written\"" + count + "\n") != std::string::npos);
+  REQUIRE(json.find("\"pipeline_buffer_bytes\"") != std::string::npos);
+
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  if (vfs.is_file("test_batched.fastq"))
+    vfs.remove_file("test_batched.fastq");
+}
+
+TEST_CASE("TileDB-FastQ: Test multi-file ingestion", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_dir_uri = "test_inputs";
+  if (vfs.is_dir(input_dir_uri))
+    vfs.remove_dir(input_dir_uri);
+  vfs.create_dir(input_dir_uri);
+
+  // Several files of distinct records and sizes, plus a file that is not
+  // FastQ.
+  const unsigned num_files = 6;
+  std::vector<std::string> paths;
+  std::vector<std::string> expected_headers;
+  for (unsigned f = 0; f < num_files; f++) {
+    paths.push_back(
+        input_dir_uri + "/lane" + std::to_string(f) + "_R1.fastq.gz");
+    std::string text;
+    const unsigned records_per_file = 4000 + 250 * f;
+    for (unsigned i = 0; i < records_per_file; i++) {
+      expected_headers.push_back(
+          "f" + std::to_string(f) + "." + std::to_string(i));
+      text += "@" + expected_headers.back() + "\nACGT\n+\nIIII\n";
+    }
+    write_gzip_file(paths.back(), text);
+  }
+  std::ofstream(input_dir_uri + "/README.txt") << "not FastQ\n";
+
+  IngestionParams params;
+  params.uri = dataset_uri;
+  params.memory_budget_mb = 4;
+  params.num_threads = 4;
+  SECTION("- List") {
+    params.input_uri = paths[0];
+    params.more_input_uris.assign(paths.begin() + 1, paths.end());
+  }
+  SECTION("- Directory") {
+    params.input_uri = input_dir_uri;
+  }
+  SECTION("- Pattern") {
+    params.input_uri = input_dir_uri + "/lane*_R1.fastq.gz";
+  }
+  SECTION("- Single worker") {
+    params.input_uri = input_dir_uri;
+    params.num_file_workers = 1;
+  }
+  Writer writer;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  const uint64_t num_records = expected_headers.size();
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  auto non_empty = array.non_empty_domain<uint64_t>();
+  REQUIRE(non_empty.size() == 1);
+  REQUIRE(non_empty[0].second.first == 0);
+  REQUIRE(non_empty[0].second.second == num_records - 1);
+
+  std::vector<uint64_t> offsets(num_records);
+  std::vector<char> data(num_records * 16);
+  tiledb::Query query(ctx, array);
+  query.set_subarray(std::vector<uint64_t>{0, num_records - 1});
+  query.set_buffer("header", offsets, data);
+  REQUIRE(query.submit() == tiledb::Query::Status::COMPLETE);
+  auto results = query.result_buffer_elements()["header"];
+  REQUIRE(results.first == num_records);
+
+  // The files are stored in input order, each as a contiguous range.
+  for (uint64_t i = 0; i < num_records; i++) {
+    uint64_t end = i + 1 < num_records ? offsets[i + 1] : results.second;
+    std::string header(data.data() + offsets[i], end - offsets[i]);
+    REQUIRE(header == expected_headers[i]);
+  }
+  array.close();
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_dir(input_dir_uri);
+}
+
+TEST_CASE("TileDB-FastQ: Test append", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+
+  // Two runs of distinct records, appended one after the other.
+  const unsigned num_runs = 2, records_per_run = 3000;
+  std::vector<std::string> paths;
+  for (unsigned f = 0; f < num_runs; f++) {
+    paths.push_back("test_run" + std::to_string(f) + ".fastq.gz");
+    std::string text;
+    for (unsigned i = 0; i < records_per_run; i++)
+      text += "@r" + std::to_string(f) + "." + std::to_string(i) +
+              "\nACGT\n+\nIIII\n";
+    write_gzip_file(paths.back(), text);
+  }
+
+  IngestionParams params;
+  params.uri = dataset_uri;
+  params.input_uri = paths[0];
+  params.memory_budget_mb = 4;
+  params.pack_sequences = false;
+  params.header_index = true;
+  Writer writer;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  // The format parameters of an append are ignored.
+  params.input_uri = paths[1];
+  params.pack_sequences = true;
+  params.header_index = false;
+  params.append = true;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  const uint64_t num_records = num_runs * records_per_run;
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  REQUIRE(format.sequence_encoding == SequenceEncoding::Raw);
+  REQUIRE(format.header_index);
+  auto non_empty = array.non_empty_domain<uint64_t>();
+  REQUIRE(non_empty.size() == 1);
+  REQUIRE(non_empty[0].second.first == 0);
+  REQUIRE(non_empty[0].second.second == num_records - 1);
+
+  std::vector<uint64_t> offsets(num_records);
+  std::vector<char> data(num_records * 16);
+  tiledb::Query query(ctx, array);
+  query.set_subarray(std::vector<uint64_t>{0, num_records - 1});
+  query.set_buffer("header", offsets, data);
+  REQUIRE(query.submit() == tiledb::Query::Status::COMPLETE);
+  auto results = query.result_buffer_elements()["header"];
+  REQUIRE(results.first == num_records);
+  for (uint64_t i = 0; i < num_records; i++) {
+    uint64_t end = i + 1 < num_records ? offsets[i + 1] : results.second;
+    std::string header(data.data() + offsets[i], end - offsets[i]);
+    REQUIRE(
+        header == "r" + std::to_string(i / records_per_run) + "." +
+                      std::to_string(i % records_per_run));
+  }
+  array.close();
+
+  // Single-end arrays take no paired-end input.
+  params.mate_input_uri = paths[0];
+  writer.set_all_params(params);
+  REQUIRE_THROWS_AS(writer.ingest(), std::runtime_error);
+
+  vfs.remove_dir(dataset_uri);
+  for (const auto& path : paths)
+    vfs.remove_file(path);
+}
+
+TEST_CASE("TileDB-FastQ: Test variable-length reads", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_var_length.fastq.gz";
+  if (vfs.is_file(input_path))
+    vfs.remove_file(input_path);
+
+  std::vector<std::string> sequences;
+  SECTION("- Mixed lengths") {
+    sequences = {"ACG", "", "ACGTACGTNN", std::string(250, 'T'), "A"};
+  }
+  SECTION("- Uniform length") {
+    sequences = {"ACGT", "TNTT", "GGGG"};
+  }
+  const bool uniform = sequences.size() == 3;
+
+  std::string text;
+  for (size_t i = 0; i < sequences.size(); i++)
+    text += "@r" + std::to_string(i) + "\n" + sequences[i] + "\n+\n" +
+            std::string(sequences[i].size(), 'I') + "\n";
+  write_gzip_file(input_path, text);
+
+  for (bool packed : {true, false}) {
+    if (vfs.is_dir(dataset_uri))
+      vfs.remove_dir(dataset_uri);
+
+    IngestionParams params;
+    params.input_uri = input_path;
+    params.uri = dataset_uri;
+    params.scan_read_length = true;
+    params.pack_sequences = packed;
+    Writer writer;
+    writer.set_all_params(params);
+    writer.ingest();
+
+    const uint64_t num_records = sequences.size();
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    format.get_metadata(&array);
+    REQUIRE(format.fixed_read_length == (uniform ? 4 : 0));
+    REQUIRE(
+        format.sequence_encoding ==
+        (packed ? SequenceEncoding::TwoBit : SequenceEncoding::Raw));
+    const bool var_sequence = packed || !uniform;
+    REQUIRE(
+        array.schema().attribute("sequence").cell_val_num() ==
+        (var_sequence ? TILEDB_VAR_NUM : 4));
+    REQUIRE(
+        array.schema().attribute("quality").cell_val_num() ==
+        (uniform ? 4 : TILEDB_VAR_NUM));
+
+    std::vector<uint64_t> seq_offsets(num_records), qual_offsets(num_records);
+    std::vector<char> seq_data(1024);
+    std::vector<uint8_t> packed_data(1024), qual_data(1024);
+    tiledb::Query query(ctx, array);
+    query.set_subarray(std::vector<uint64_t>{0, num_records - 1});
+    if (packed)
+      query.set_buffer("sequence", seq_offsets, packed_data);
+    else if (var_sequence)
+      query.set_buffer("sequence", seq_offsets, seq_data);
+    else
+      query.set_buffer("sequence", seq_data);
+    if (uniform)
+      query.set_buffer("quality", qual_data);
+    else
+      query.set_buffer("quality", qual_offsets, qual_data);
+    REQUIRE(query.submit() == tiledb::Query::Status::COMPLETE);
+    auto result_el = query.result_buffer_elements();
+
+    // Returns the [start, end) range of cell i.
+    auto cell_range = [&](const std::string& attr, bool var, uint64_t i) {
+      const auto& offsets = attr == "sequence" ? seq_offsets : qual_offsets;
+      if (!var)
+        return std::make_pair(i * 4, i * 4 + 4);
+      return std::make_pair(
+          offsets[i],
+          i + 1 < num_records ? offsets[i + 1] : result_el[attr].second);
+    };
+
+    for (uint64_t i = 0; i < num_records; i++) {
+      auto seq_range = cell_range("sequence", var_sequence, i);
+      auto qual_range = cell_range("quality", !uniform, i);
+      const uint64_t qual_size = qual_range.second - qual_range.first;
+      std::string seq;
+      if (packed) {
+        seq.resize(qual_size);
+        sequence_codec::decode(
+            &packed_data[seq_range.first],
+            seq_range.second - seq_range.first,
+            qual_size,
+            &seq[0]);
+      } else {
+        seq.assign(
+            &seq_data[seq_range.first], seq_range.second - seq_range.first);
+      }
+
+      if (sequences[i].empty()) {
+        REQUIRE(seq == "N");
+        REQUIRE(qual_size == 1);
+        REQUIRE(qual_data[qual_range.first] == EMPTY_READ_QUALITY);
+      } else {
+        REQUIRE(seq == sequences[i]);
+        REQUIRE(qual_size == sequences[i].size());
+        for (uint64_t j = qual_range.first; j < qual_range.second; j++)
+          REQUIRE(qual_data[j] == 'I' - '!');
+      }
+    }
+    array.close();
+  }
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test quality binning", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_quality.fastq.gz";
+  if (vfs.is_file(input_path))
+    vfs.remove_file(input_path);
+
+  const std::vector<std::string> qualities = {"!#$+5?IJ~", "II", "#"};
+  std::string text;
+  for (size_t i = 0; i < qualities.size(); i++)
+    text += "@r" + std::to_string(i) + "\n" +
+            std::string(qualities[i].size(), 'A') + "\n+\n" + qualities[i] +
+            "\n";
+  write_gzip_file(input_path, text);
+
+  IngestionParams params;
+  params.input_uri = input_path;
+  params.uri = dataset_uri;
+  std::vector<quality_bins::Bin> bins;
+  SECTION("- Lossless") {
+    params.quality_mode = "lossless";
+  }
+  SECTION("- Illumina") {
+    params.quality_mode = "illumina8";
+    bins = quality_bins::illumina8();
+  }
+  SECTION("- Custom") {
+    params.quality_mode = "0:1,30:40";
+    bins = quality_bins::parse(params.quality_mode);
+  }
+  Writer writer;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  REQUIRE(
+      quality_bins::to_string(format.quality_bin_table) ==
+      quality_bins::to_string(bins));
+
+  const uint64_t num_records = qualities.size();
+  std::vector<uint64_t> offsets(num_records);
+  std::vector<uint8_t> data(1024);
+  tiledb::Query query(ctx, array);
+  query.set_subarray(std::vector<uint64_t>{0, num_records - 1});
+  query.set_buffer("quality", offsets, data);
+  REQUIRE(query.submit() == tiledb::Query::Status::COMPLETE);
+  REQUIRE(query.result_buffer_elements()["quality"].second == 12);
+
+  uint8_t index[quality_bins::MAX_SCORE + 1];
+  if (!bins.empty())
+    quality_bins::make_index_table(bins, index);
+  uint64_t pos = 0;
+  for (uint64_t i = 0; i < num_records; i++) {
+    REQUIRE(offsets[i] == pos);
+    for (char c : qualities[i]) {
+      const uint8_t score = uint8_t(c - '!');
+      if (bins.empty())
+        REQUIRE(data[pos] == score);
+      else
+        REQUIRE(bins.at(data[pos]).value == bins[index[score]].value);
+      pos++;
+    }
+  }
+  array.close();
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test compression presets", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_compression.fastq.gz";
+  if (vfs.is_file(input_path))
+    vfs.remove_file(input_path);
+
+  const std::string text = "@r0\nACGT\n+\nIIII\n@r1\nAC\n+\n##\n";
+  write_gzip_file(input_path, text);
+
+  IngestionParams params;
+  params.input_uri = input_path;
+  params.uri = dataset_uri;
+  SECTION("- Preset") {
+    params.compression = "fast-ingest";
+    Writer writer;
+    writer.set_all_params(params);
+    writer.ingest();
+
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    format.get_metadata(&array);
+    REQUIRE(format.filters.preset == "fast-ingest");
+    REQUIRE(
+        compression::to_string(format.filters) ==
+        compression::to_string(compression::preset("fast-ingest")));
+    auto schema = array.schema();
+    auto filters = schema.attribute("quality").filter_list();
+    REQUIRE(filters.nfilters() == 1);
+    REQUIRE(filters.filter(0).filter_type() == TILEDB_FILTER_LZ4);
+    filters = schema.offsets_filter_list();
+    REQUIRE(filters.nfilters() == 2);
+    REQUIRE(filters.filter(0).filter_type() == TILEDB_FILTER_DOUBLE_DELTA);
+    REQUIRE(filters.filter(1).filter_type() == TILEDB_FILTER_LZ4);
+    array.close();
+  }
+  SECTION("- Overrides") {
+    params.compression = "balanced";
+    params.filters = "quality=bitshuffle+zstd:9,offsets=none";
+    Writer writer;
+    writer.set_all_params(params);
+    writer.ingest();
+
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    format.get_metadata(&array);
+    REQUIRE(format.filters.preset == "balanced");
+    REQUIRE(
+        compression::to_string(format.filters) ==
+        "description=zstd:3,header=zstd:3,offsets=none,"
+        "quality=bitshuffle+zstd:9,sequence=zstd:3");
+    auto filters = array.schema().attribute("quality").filter_list();
+    REQUIRE(filters.nfilters() == 2);
+    REQUIRE(filters.filter(0).filter_type() == TILEDB_FILTER_BITSHUFFLE);
+    REQUIRE(filters.filter(1).filter_type() == TILEDB_FILTER_ZSTD);
+    int32_t level;
+    filters.filter(1).get_option(TILEDB_COMPRESSION_LEVEL, &level);
+    REQUIRE(level == 9);
+    REQUIRE(array.schema().offsets_filter_list().nfilters() == 0);
+    array.close();
+  }
+  SECTION("- Invalid") {
+    params.compression = "fastest";
+    Writer writer;
+    writer.set_all_params(params);
+    REQUIRE_THROWS_AS(writer.ingest(), std::runtime_error);
+    params.compression = "balanced";
+    params.filters = "comment=zstd";
+    writer.set_all_params(params);
+    REQUIRE_THROWS_AS(writer.ingest(), std::runtime_error);
+  }
+
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test tile extent", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_tile_extent.fastq.gz";
+  std::string mate_path = "test_tile_extent_2.fastq.gz";
+  for (const auto& path : {input_path, mate_path})
+    if (vfs.is_file(path))
+      vfs.remove_file(path);
+
+  // Tiles of the qualities of the first reads are about the target size.
+  size_t read_length = 100;
+  IngestionParams params;
+  params.input_uri = input_path;
+  params.uri = dataset_uri;
+  uint64_t expected = 0;
+  SECTION("- Short reads") {
+    expected = 8 * 1024 * 1024 / 100;
+  }
+  SECTION("- Long reads") {
+    read_length = 10000;
+    expected = 8 * 1024 * 1024 / 10000;
+  }
+  SECTION("- Memory budget") {
+    params.memory_budget_mb = 16;
+    expected = 1024 * 1024 / 100;
+  }
+  SECTION("- Override") {
+    params.tile_extent = 500;
+    expected = 500;
+  }
+  SECTION("- Paired") {
+    // Tiles hold whole pairs, so the extent is rounded down to even.
+    params.mate_input_uri = mate_path;
+    params.memory_budget_mb = 16;
+    expected = 1024 * 1024 / 100 - 1;
+  }
+  SECTION("- Paired override") {
+    params.mate_input_uri = mate_path;
+    params.tile_extent = 500;
+    expected = 500;
+  }
+
+  std::string text;
+  for (unsigned i = 0; i < 100; i++)
+    text += "@r" + std::to_string(i) + "\n" + std::string(read_length, 'A') +
+            "\n+\n" + std::string(read_length, 'I') + "\n";
+  write_gzip_file(input_path, text);
+  write_gzip_file(mate_path, text);
+
+  Writer writer;
+  writer.set_all_params(params);
+  writer.ingest();
+
+  tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+  StorageFormat format;
+  format.get_metadata(&array);
+  REQUIRE(format.tile_extent == expected);
+  REQUIRE(
+      array.schema().domain().dimension("d1").tile_extent<uint64_t>() ==
+      expected);
+  array.close();
+
+  if (!params.mate_input_uri.empty())
+    REQUIRE(format.tile_extent % 2 == 0);
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_path);
+}
+
+TEST_CASE(
+    "TileDB-FastQ: Test odd tile extent of paired-end reads",
+    "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_tile_extent.fastq.gz";
+  std::string mate_path = "test_tile_extent_2.fastq.gz";
+  write_gzip_file(input_path, "@r0\nACGT\n+\nIIII\n");
+  write_gzip_file(mate_path, "@r0\nACGT\n+\nIIII\n");
+
+  IngestionParams params;
+  params.input_uri = input_path;
+  params.mate_input_uri = mate_path;
+  params.uri = dataset_uri;
+  params.tile_extent = 501;
+  Writer writer;
+  writer.set_all_params(params);
+  REQUIRE_THROWS_AS(writer.ingest(), std::runtime_error);
+  REQUIRE(!vfs.is_dir(dataset_uri));
+
+  vfs.remove_file(input_path);
+  vfs.remove_file(mate_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test storage format metadata", "[tiledbfq][ingest]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+
+  tiledb::Domain dom(ctx);
+  dom.add_dimension(
+      tiledb::Dimension::create<uint64_t>(ctx, "d1", {{0, 999}}, 10));
+  tiledb::ArraySchema schema(ctx, TILEDB_DENSE);
+  schema.set_domain(dom);
+  auto quality = tiledb::Attribute::create<uint8_t>(ctx, "quality");
+  quality.set_cell_val_num(TILEDB_VAR_NUM);
+  schema.add_attribute(quality);
+  tiledb::Array::create(dataset_uri, schema);
+
+  SECTION("- Without metadata") {
+    // Arrays written before the format was recorded.
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    format.get_metadata(&array);
+    REQUIRE(format.sequence_encoding == SequenceEncoding::Raw);
+    REQUIRE(format.fixed_read_length == 0);
+    REQUIRE(format.tile_extent == 10);
+    REQUIRE(format.filters.preset == "bzip2");
+    array.close();
+  }
+  SECTION("- Missing keys") {
+    {
+      tiledb::Array array(ctx, dataset_uri, TILEDB_WRITE);
+      const std::string encoding = "raw";
+      const uint32_t read_length = 0;
+      array.put_metadata(
+          "sequence_encoding",
+          TILEDB_CHAR,
+          (uint32_t)encoding.size(),
+          encoding.data());
+      array.put_metadata("fixed_read_length", TILEDB_UINT32, 1, &read_length);
+      array.close();
+    }
+    tiledb::Array array(ctx, dataset_uri, TILEDB_READ);
+    StorageFormat format;
+    REQUIRE_THROWS_AS(format.get_metadata(&array), std::runtime_error);
+    array.close();
+  }
+
+  vfs.remove_dir(dataset_uri);
+}
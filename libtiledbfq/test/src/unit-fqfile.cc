@@ -28,17 +28,68 @@
  */
 
 #include "catch.hpp"
+#include "helpers.h"
 
 #include "write/fqfile.h"
 
+#include <sys/stat.h>
+#include <zlib.h>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace tiledb::fq;
+using namespace tiledb::fq::test;
 
 static const std::string input_dir = TILEDB_FASTQ_TEST_INPUT_DIR;
 
+namespace {
+/** Writes the given text to a BGZF file, in blocks of the given size. */
+void write_bgzf_file(
+    const std::string& path, const std::string& text, size_t block_bytes) {
+  std::ofstream os(path, std::ios::binary);
+  auto write_le = [&os](uint32_t v, unsigned bytes) {
+    for (unsigned i = 0; i < bytes; i++)
+      os.put(char((v >> (8 * i)) & 0xff));
+  };
+  auto write_block = [&](const char* data, size_t size) {
+    std::vector<unsigned char> cdata(compressBound((uLong)size) + 64);
+    z_stream strm;
+    std::memset(&strm, 0, sizeof(strm));
+    REQUIRE(
+        deflateInit2(
+            &strm,
+            Z_DEFAULT_COMPRESSION,
+            Z_DEFLATED,
+            -15,
+            8,
+            Z_DEFAULT_STRATEGY) == Z_OK);
+    strm.next_in = (Bytef*)data;
+    strm.avail_in = (uInt)size;
+    strm.next_out = cdata.data();
+    strm.avail_out = (uInt)cdata.size();
+    REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    const size_t csize = cdata.size() - strm.avail_out;
+    deflateEnd(&strm);
+
+    const unsigned char header[16] = {
+        31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0};
+    os.write((const char*)header, sizeof(header));
+    write_le(uint32_t(sizeof(header) + 2 + csize + 8 - 1), 2);
+    os.write((const char*)cdata.data(), csize);
+    write_le(crc32(0, (const Bytef*)data, (uInt)size), 4);
+    write_le(uint32_t(size), 4);
+  };
+  for (size_t i = 0; i < text.size(); i += block_bytes)
+    write_block(text.data() + i, std::min(block_bytes, text.size() - i));
+  // Empty end-of-file block.
+  write_block(nullptr, 0);
+}
+}  // namespace
+
 TEST_CASE("TileDB-FastQ: Test FQFile", "[tiledbfq][fqfile]") {
   tiledb::Context ctx;
   tiledb::VFS vfs(ctx);
@@ -92,4 +143,248 @@ TEST_CASE("TileDB-FastQ: Test FQFile", "[tiledbfq][fqfile]") {
 
   if (vfs.is_dir(dataset_uri))
     vfs.remove_dir(dataset_uri);
-}
\ No newline at end of file
+}
+
+TEST_CASE("TileDB-FastQ: Test FQFile streaming", "[tiledbfq][fqfile]") {
+  FQFile fq_whole, fq_windowed;
+  fq_whole.set_memory_budget(64);
+  fq_whole.open(input_dir + "/SRR062641.filt.fastq.gz");
+  fq_windowed.set_memory_budget(1);
+  fq_windowed.open(input_dir + "/SRR062641.filt.fastq.gz");
+
+  FQFile::FQRecord rec1, rec2;
+  size_t num_records = 0;
+  while (fq_whole.next_record(&rec1)) {
+    REQUIRE(fq_windowed.next_record(&rec2));
+    REQUIRE(rec1.header == rec2.header);
+    REQUIRE(rec1.sequence == rec2.sequence);
+    REQUIRE(rec1.description == rec2.description);
+    REQUIRE(rec1.qualities == rec2.qualities);
+    num_records++;
+  }
+  REQUIRE(!fq_windowed.next_record(&rec2));
+  REQUIRE(num_records == 109811);
+}
+
+TEST_CASE(
+    "TileDB-FastQ: Test FQFile multi-member gzip", "[tiledbfq][fqfile]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string path = "test_multi_member.fastq.gz";
+  if (vfs.is_file(path))
+    vfs.remove_file(path);
+
+  // Write three gzip members, the last record without a trailing newline.
+  const std::vector<std::string> members = {
+      "@r1\nACGT\n+\nIIII\n@r2\nAC", "GTN\n+r2\n#####\n", "@r3\nA\n+\n!"};
+  for (const auto& m : members)
+    write_gzip_file(path, m, true);
+
+  FQFile fq;
+  fq.open(path);
+  FQFile::FQRecord rec;
+  REQUIRE(fq.next_record(&rec));
+  REQUIRE(rec.header == "r1");
+  REQUIRE(rec.sequence == "ACGT");
+  REQUIRE(rec.qualities == std::vector<uint8_t>{40, 40, 40, 40});
+  REQUIRE(fq.next_record(&rec));
+  REQUIRE(rec.header == "r2");
+  REQUIRE(rec.sequence == "ACGTN");
+  REQUIRE(rec.description == "r2");
+  REQUIRE(fq.next_record(&rec));
+  REQUIRE(rec.header == "r3");
+  REQUIRE(rec.sequence == "A");
+  REQUIRE(rec.qualities == std::vector<uint8_t>{0});
+  REQUIRE(!fq.next_record(&rec));
+
+  vfs.remove_file(path);
+}
+
+TEST_CASE("TileDB-FastQ: Test FQFile BGZF", "[tiledbfq][fqfile]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string path = "test_input.fastq.bgz";
+  if (vfs.is_file(path))
+    vfs.remove_file(path);
+
+  const std::string input = input_dir + "/SRR062641.filt.fastq.gz";
+  write_bgzf_file(path, read_gzip_file(input), 60000);
+
+  for (unsigned num_threads : {1, 4}) {
+    FQFile fq_gzip, fq_bgzf;
+    fq_gzip.open(input);
+    fq_bgzf.set_memory_budget(1);
+    fq_bgzf.set_num_threads(num_threads);
+    fq_bgzf.open(path);
+
+    FQFile::FQRecord rec1, rec2;
+    size_t num_records = 0;
+    while (fq_gzip.next_record(&rec1)) {
+      REQUIRE(fq_bgzf.next_record(&rec2));
+      REQUIRE(rec1.header == rec2.header);
+      REQUIRE(rec1.sequence == rec2.sequence);
+      REQUIRE(rec1.qualities == rec2.qualities);
+      num_records++;
+    }
+    REQUIRE(!fq_bgzf.next_record(&rec2));
+    REQUIRE(num_records == 109811);
+  }
+
+  vfs.remove_file(path);
+}
+
+TEST_CASE("TileDB-FastQ: Test FQFile stream input", "[tiledbfq][fqfile]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  const std::string input = input_dir + "/SRR062641.filt.fastq.gz";
+  const std::string text = read_gzip_file(input);
+  std::string path = "test_input.fastq";
+  if (vfs.is_file(path))
+    vfs.remove_file(path);
+  std::remove(path.c_str());
+
+  // The contents fed through a FIFO, in each supported compression.
+  std::string contents;
+  bool fifo = true;
+  SECTION("- Plain") {
+    contents = text;
+  }
+  SECTION("- Gzip") {
+    contents = read_file(input);
+  }
+  SECTION("- BGZF") {
+    write_bgzf_file(path, text, 60000);
+    contents = read_file(path);
+    std::remove(path.c_str());
+  }
+  SECTION("- Plain file") {
+    std::ofstream(path, std::ios::binary) << text;
+    fifo = false;
+  }
+
+  std::thread feeder;
+  if (fifo) {
+    REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+    REQUIRE(FQFile::is_stream(path));
+    feeder = std::thread([&]() {
+      std::ofstream os(path, std::ios::binary);
+      os.write(contents.data(), contents.size());
+    });
+  } else {
+    REQUIRE(!FQFile::is_stream(path));
+  }
+
+  FQFile fq_gzip, fq_stream;
+  fq_gzip.open(input);
+  fq_stream.set_memory_budget(1);
+  fq_stream.open(path);
+  REQUIRE(!fq_gzip.is_mapped());
+  REQUIRE(fq_stream.is_mapped() == !fifo);
+  FQFile::FQRecord rec1, rec2;
+  size_t num_records = 0;
+  while (fq_gzip.next_record(&rec1)) {
+    REQUIRE(fq_stream.next_record(&rec2));
+    REQUIRE(rec1.header == rec2.header);
+    REQUIRE(rec1.sequence == rec2.sequence);
+    REQUIRE(rec1.qualities == rec2.qualities);
+    num_records++;
+  }
+  REQUIRE(!fq_stream.next_record(&rec2));
+  REQUIRE(num_records > 0);
+
+  if (feeder.joinable())
+    feeder.join();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("TileDB-FastQ: Test FQFile mapped input", "[tiledbfq][fqfile]") {
+  std::string path = "test_mapped.fastq";
+  std::remove(path.c_str());
+
+  // Enough records for many windows, the last without a trailing newline.
+  std::string text;
+  for (unsigned i = 0; i < 2000; i++)
+    text += "@r" + std::to_string(i) + "\nACGTACGTAC\n+\nIIIIIIIIII\n";
+  text += "@last\nAC\n+\n!!";
+  std::ofstream(path, std::ios::binary) << text;
+
+  FQFile fq;
+  fq.set_memory_budget_bytes(8192);
+  SECTION("- Path") {
+    fq.open(path);
+  }
+  SECTION("- File URI") {
+    fq.open("file://" + path);
+  }
+  REQUIRE(fq.is_mapped());
+
+  // Chunks are views of the mapping, which stay valid once released.
+  Buffer chunk;
+  std::string chunks;
+  std::vector<Buffer> views;
+  while (fq.next_chunk(&chunk)) {
+    REQUIRE(chunk.is_view());
+    chunks.append(chunk.data<char>(), chunk.size());
+    fq.release_chunk(chunk);
+    views.push_back(std::move(chunk));
+  }
+  REQUIRE(chunks == text);
+  REQUIRE(views.size() > 1);
+  REQUIRE(fq.num_bytes_read() == text.size());
+  std::string released;
+  for (const auto& view : views)
+    released.append(view.data<char>(), view.size());
+  REQUIRE(released == text);
+
+  // Clearing a view gives the buffer its own allocation again.
+  fq.open(path);
+  REQUIRE(fq.next_chunk(&chunk));
+  REQUIRE(chunk.is_view());
+  chunk.clear();
+  chunk.append("@r\n", 3);
+  REQUIRE(!chunk.is_view());
+  REQUIRE(std::string(chunk.data<char>(), chunk.size()) == "@r\n");
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("TileDB-FastQ: Test FQFile record views", "[tiledbfq][fqfile]") {
+  const std::string text =
+      "@r1 x\nACGT\n+\nIIII\n@r2\n\n+d2\n\n@r3\nNA\n+\n!~";
+  const char* p = text.data();
+  const char* end = p + text.size();
+  FQFile::FQRecordView view;
+
+  p = FQFile::parse_record_view(p, end, &view);
+  REQUIRE(view.header.str() == "r1 x");
+  REQUIRE(view.sequence.str() == "ACGT");
+  REQUIRE(view.description.str() == "");
+  REQUIRE(view.quality.str() == "IIII");
+
+  p = FQFile::parse_record_view(p, end, &view);
+  REQUIRE(view.header.str() == "r2");
+  REQUIRE(view.sequence.size == 0);
+  REQUIRE(view.description.str() == "d2");
+  REQUIRE(view.quality.size == 0);
+
+  p = FQFile::parse_record_view(p, end, &view);
+  REQUIRE(p == end);
+  REQUIRE(view.sequence.str() == "NA");
+  std::vector<uint8_t> scores(view.quality.size);
+  FQFile::parse_quality_string(view.quality, scores.data());
+  REQUIRE(scores == std::vector<uint8_t>{0, 93});
+
+  const std::string bad = "@r1\nACGT\n+\nIII\n";
+  REQUIRE_THROWS_AS(
+      FQFile::parse_record_view(bad.data(), bad.data() + bad.size(), &view),
+      std::runtime_error);
+  const std::string bad_quality = "II I";
+  scores.resize(bad_quality.size());
+  REQUIRE_THROWS_AS(
+      FQFile::parse_quality_string(
+          {bad_quality.data(), bad_quality.size()}, scores.data()),
+      std::runtime_error);
+}
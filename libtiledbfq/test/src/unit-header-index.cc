@@ -0,0 +1,149 @@
+/**
+ * @file   unit-header-index.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the header index.
+ */
+
+#include "catch.hpp"
+#include "helpers.h"
+
+#include "read/reader.h"
+#include "utils/header_index.h"
+#include "write/writer.h"
+
+#include <fstream>
+
+using namespace tiledb::fq;
+using namespace tiledb::fq::test;
+
+TEST_CASE("TileDB-FastQ: Test read name hashing", "[tiledbfq][index]") {
+  REQUIRE(header_index::name_length("r1 extra", 8) == 2);
+  REQUIRE(header_index::name_length("r1\textra", 8) == 2);
+  REQUIRE(header_index::name_length("r1", 2) == 2);
+  REQUIRE(header_index::name_length("", 0) == 0);
+
+  auto a = header_index::hash_name("SRR062641.1", 11);
+  auto b = header_index::hash_name("SRR062641.1", 11);
+  auto c = header_index::hash_name("SRR062641.2", 11);
+  REQUIRE(a.key == b.key);
+  REQUIRE(a.check == b.check);
+  REQUIRE(a.key != c.key);
+  REQUIRE(a.check != c.check);
+  REQUIRE(a.key < (uint64_t(1) << 62));
+}
+
+TEST_CASE("TileDB-FastQ: Test lookup by read name", "[tiledbfq][index]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_index.fastq.gz";
+  std::string names_path = "test_index_names.txt";
+  std::string output_path = "test_index.fastq";
+
+  // Mates of a pair share a name.
+  const std::string r0 = "@p1 1:N\nACGT\n+\nIIII\n";
+  const std::string r1 = "@p2 1:N\nCCCC\n+\nIIII\n";
+  const std::string r2 = "@p1 2:N\nGGGG\n+\nIIII\n";
+  const std::string r3 = "@q7\nTTTT\n+\nIIII\n";
+  write_gzip_file(input_path, r0 + r1 + r2 + r3);
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  store_params.header_index = true;
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  export_params.output_uri = output_path;
+  Reader reader;
+  reader.set_all_params(export_params);
+
+  REQUIRE(reader.lookup({"q7"}) == std::vector<uint64_t>{3});
+  REQUIRE(reader.lookup({"@p1"}) == std::vector<uint64_t>{0, 2});
+  REQUIRE(reader.lookup({"p2 2:N", "q7", "p2"}) == std::vector<uint64_t>{1, 3});
+  REQUIRE(reader.lookup({"p", "q77", "x"}).empty());
+
+  SECTION("- Export by name") {
+    std::ofstream(names_path) << "q7\n\n@p1\nmissing\n";
+    export_params.names_uri = names_path;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == r0 + r2 + r3);
+  }
+
+  SECTION("- Export by name in range") {
+    std::ofstream(names_path) << "q7\np1\n";
+    export_params.names_uri = names_path;
+    export_params.record_start = 1;
+    reader.set_all_params(export_params);
+    reader.export_fastq();
+    REQUIRE(read_file(output_path) == r2 + r3);
+  }
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+  if (vfs.is_file(names_path))
+    vfs.remove_file(names_path);
+  if (vfs.is_file(output_path))
+    vfs.remove_file(output_path);
+}
+
+TEST_CASE("TileDB-FastQ: Test lookup without index", "[tiledbfq][index]") {
+  tiledb::Context ctx;
+  tiledb::VFS vfs(ctx);
+
+  std::string dataset_uri = "test_dataset";
+  if (vfs.is_dir(dataset_uri))
+    vfs.remove_dir(dataset_uri);
+  std::string input_path = "test_index.fastq.gz";
+  write_gzip_file(input_path, "@r1\nACGT\n+\nIIII\n");
+
+  IngestionParams store_params;
+  store_params.uri = dataset_uri;
+  store_params.input_uri = input_path;
+  Writer writer;
+  writer.set_all_params(store_params);
+  writer.ingest();
+
+  ExportParams export_params;
+  export_params.uri = dataset_uri;
+  Reader reader;
+  reader.set_all_params(export_params);
+  REQUIRE_THROWS(reader.lookup({"r1"}));
+
+  vfs.remove_dir(dataset_uri);
+  vfs.remove_file(input_path);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file   unit-header-tokens.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the header tokenizer.
+ */
+
+#include "catch.hpp"
+
+#include "utils/header_tokens.h"
+
+#include <stdexcept>
+
+using namespace tiledb::fq;
+
+namespace {
+/** Splits a header and joins it back, or returns "" if it does not match. */
+std::string split_join(
+    const std::vector<header_tokens::Field>& fields,
+    const std::string& header) {
+  std::vector<header_tokens::Token> tokens(fields.size());
+  if (!header_tokens::split(fields, header.data(), header.size(), &tokens[0]))
+    return "";
+  std::string joined(header_tokens::max_joined_size(fields) + header.size(), 0);
+  char* end = header_tokens::join(fields, tokens.data(), &joined[0]);
+  joined.resize(end - joined.data());
+  return joined;
+}
+}  // namespace
+
+TEST_CASE("TileDB-FastQ: Test header tokens", "[tiledbfq][header]") {
+  SECTION("- Illumina") {
+    const std::vector<std::string> headers = {
+        "A00123:8:H7KXX:1:1101:1000:2000 1:N:0:ACGT+TTGA",
+        "A00123:8:H7KXX:1:1101:1012:2017 1:N:0:ACGA+TTGA",
+        "A00123:8:H7KXX:2:1102:25:10 2:Y:0:ACGT+TTGC"};
+    auto fields = header_tokens::infer(headers);
+    REQUIRE(fields.size() == 11);
+    REQUIRE(
+        header_tokens::to_string(fields) ==
+        "cA00123:c8:cH7KXX:i:i:i:i i:s:c0:s");
+    REQUIRE(
+        header_tokens::to_string(
+            header_tokens::parse(header_tokens::to_string(fields))) ==
+        header_tokens::to_string(fields));
+    for (const auto& header : headers)
+      REQUIRE(split_join(fields, header) == header);
+
+    std::vector<header_tokens::Token> tokens(fields.size());
+    REQUIRE(header_tokens::split(
+        fields, headers[1].data(), headers[1].size(), tokens.data()));
+    REQUIRE(tokens[5].number == 1012);
+    REQUIRE(tokens[6].number == 2017);
+    REQUIRE(tokens[10].size == 9);
+
+    // Other instruments, leading zeros, and other shapes do not match.
+    for (const std::string header :
+         {"B00123:8:H7KXX:1:1101:1000:2000 1:N:0:ACGT",
+          "A00123:8:H7KXX:1:1101:0100:2000 1:N:0:ACGT",
+          "A00123:8:H7KXX:1:1101:1000:2000 1:N:0:",
+          "A00123:8:H7KXX:1:1101:1000:2000",
+          "A00123:8:H7KXX:1:1101:1000:2000 1:N:0:ACGT:",
+          ""})
+      REQUIRE(split_join(fields, header).empty());
+  }
+
+  SECTION("- Read numbers") {
+    const std::vector<std::string> headers = {
+        "SRR062641.1 HWI-EAS110_103327062:5:1:1091:7885/1",
+        "SRR062641.2 HWI-EAS110_103327062:5:1:1091:19045/1",
+        "SRR062641.3 HWI-EAS110_103327062:5:1:1092:8563/1"};
+    auto fields = header_tokens::infer(headers);
+    REQUIRE(
+        header_tokens::to_string(fields) ==
+        "cSRR062641.i cHWI-EAS110_c103327062:c5:c1:i:i/c1");
+    for (const auto& header : headers)
+      REQUIRE(split_join(fields, header) == header);
+    // Integers of up to 19 digits always fit in 64 bits.
+    const std::string max_header =
+        "SRR062641.9999999999999999999 HWI-EAS110_103327062:5:1:0:0/1";
+    REQUIRE(split_join(fields, max_header) == max_header);
+    REQUIRE(split_join(
+                fields,
+                "SRR062641.10000000000000000000 HWI-EAS110_103327062:5:1:0:0/1")
+                .empty());
+  }
+
+  SECTION("- Empty delimiters") {
+    const std::vector<std::string> headers = {"r:1::", "r:2::", "r:3::"};
+    auto fields = header_tokens::infer(headers);
+    REQUIRE(header_tokens::to_string(fields) == "cr:i:c:");
+    REQUIRE(split_join(fields, "r:10::") == "r:10::");
+    REQUIRE(split_join(fields, "r:10:").empty());
+  }
+
+  SECTION("- No columns") {
+    REQUIRE(header_tokens::infer({}).empty());
+    REQUIRE(header_tokens::infer({"read-a", "read-b"}).empty());
+  }
+
+  SECTION("- Invalid template") {
+    REQUIRE_THROWS_AS(header_tokens::parse("x"), std::runtime_error);
+    REQUIRE_THROWS_AS(header_tokens::parse("ii"), std::runtime_error);
+    REQUIRE(header_tokens::parse("").empty());
+  }
+}
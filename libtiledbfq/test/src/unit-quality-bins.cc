@@ -0,0 +1,79 @@
+/**
+ * @file   unit-quality-bins.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for quality score binning.
+ */
+
+#include "catch.hpp"
+
+#include "utils/quality_bins.h"
+
+#include <stdexcept>
+
+using namespace tiledb::fq;
+
+TEST_CASE("TileDB-FastQ: Test quality bins", "[tiledbfq][quality]") {
+  SECTION("- Illumina") {
+    auto bins = quality_bins::illumina8();
+    REQUIRE(bins.size() == 8);
+    REQUIRE(
+        quality_bins::to_string(bins) ==
+        "0:2,3:6,10:15,20:22,25:27,30:33,35:37,40:40");
+    uint8_t index[quality_bins::MAX_SCORE + 1];
+    quality_bins::make_index_table(bins, index);
+    REQUIRE(bins[index[0]].value == 2);
+    REQUIRE(bins[index[2]].value == 2);
+    REQUIRE(bins[index[3]].value == 6);
+    REQUIRE(bins[index[19]].value == 15);
+    REQUIRE(bins[index[20]].value == 22);
+    REQUIRE(bins[index[39]].value == 37);
+    REQUIRE(bins[index[40]].value == 40);
+    REQUIRE(bins[index[quality_bins::MAX_SCORE]].value == 40);
+  }
+
+  SECTION("- Custom") {
+    auto bins = quality_bins::parse("0:5,10:20,30:35");
+    REQUIRE(bins.size() == 3);
+    REQUIRE(quality_bins::to_string(bins) == "0:5,10:20,30:35");
+    uint8_t index[quality_bins::MAX_SCORE + 1];
+    quality_bins::make_index_table(bins, index);
+    REQUIRE(index[9] == 0);
+    REQUIRE(index[10] == 1);
+    REQUIRE(index[29] == 1);
+    REQUIRE(index[30] == 2);
+    REQUIRE(index[quality_bins::MAX_SCORE] == 2);
+  }
+
+  SECTION("- Invalid") {
+    for (const char* spec :
+         {"", "1:5", "0:5,0:6", "0:5,10:20,5:7", "0:x", "0:5:6", "0:100"})
+      REQUIRE_THROWS_AS(quality_bins::parse(spec), std::runtime_error);
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file   unit-scan.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the vectorized FastQ scanning functions.
+ */
+
+#include "catch.hpp"
+
+#include "utils/scan.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tiledb::fq;
+
+TEST_CASE("TileDB-FastQ: Test scan newlines", "[tiledbfq][scan]") {
+  std::mt19937 gen(0);
+  for (size_t size = 0; size < 300; size++) {
+    std::string text(size, 'A');
+    std::vector<const char*> expected;
+    for (size_t i = 0; i < size; i++) {
+      if (gen() % 8 == 0) {
+        text[i] = '\n';
+        expected.push_back(text.data() + i);
+      }
+    }
+    const char* begin = text.data();
+    const char* end = begin + size;
+
+    std::vector<const char*> found(expected.size() + 1);
+    REQUIRE(
+        scan::find_newlines(begin, end, found.size(), found.data()) ==
+        expected.size());
+    found.resize(expected.size());
+    REQUIRE(found == expected);
+    if (expected.size() >= 2) {
+      REQUIRE(scan::find_newlines(begin, end, 2, found.data()) == 2);
+      REQUIRE(found[1] == expected[1]);
+    }
+
+    for (unsigned group_lines : {1, 4}) {
+      const size_t num_groups = expected.size() / group_lines;
+      const char* groups_end =
+          num_groups == 0 ? begin : expected[num_groups * group_lines - 1] + 1;
+      REQUIRE(scan::find_groups_end(begin, end, group_lines) == groups_end);
+    }
+  }
+}
+
+TEST_CASE("TileDB-FastQ: Test scan qualities", "[tiledbfq][scan]") {
+  std::mt19937 gen(0);
+  for (size_t size = 0; size < 300; size++) {
+    std::string text(size, 'A');
+    for (auto& c : text)
+      c = char('!' + gen() % 94);
+    std::vector<uint8_t> scores(size);
+    REQUIRE(scan::quality_scores(text.data(), size, scores.data()));
+    for (size_t i = 0; i < size; i++)
+      REQUIRE(scores[i] == uint8_t(text[i] - '!'));
+
+    if (size > 0) {
+      for (char invalid : {' ', '\x7f', '\n', '\xff'}) {
+        std::string bad = text;
+        bad[gen() % size] = invalid;
+        REQUIRE(!scan::quality_scores(bad.data(), size, scores.data()));
+      }
+    }
+  }
+}
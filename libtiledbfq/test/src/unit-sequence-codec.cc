@@ -0,0 +1,104 @@
+/**
+ * @file   unit-sequence-codec.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the 2-bit sequence codec.
+ */
+
+#include "catch.hpp"
+
+#include "utils/sequence_codec.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace tiledb::fq;
+
+namespace {
+std::string round_trip(const std::string& bases) {
+  std::vector<uint8_t> cell(sequence_codec::max_encoded_size(bases.size()));
+  const size_t cell_size =
+      sequence_codec::encode(bases.data(), bases.size(), cell.data());
+  REQUIRE(cell_size <= cell.size());
+  std::string result(bases.size(), '\0');
+  sequence_codec::decode(cell.data(), cell_size, bases.size(), &result[0]);
+  return result;
+}
+}  // namespace
+
+TEST_CASE("TileDB-FastQ: Test sequence codec", "[tiledbfq][codec]") {
+  SECTION("- Packed size") {
+    std::vector<uint8_t> cell(sequence_codec::max_encoded_size(9));
+    REQUIRE(sequence_codec::encode("ACGTACGTA", 9, cell.data()) == 3);
+    REQUIRE(cell[0] == 0xe4);
+    REQUIRE(cell[1] == 0xe4);
+    REQUIRE(cell[2] == 0x00);
+    REQUIRE(sequence_codec::encode("NACGT", 5, cell.data()) == 4);
+  }
+
+  SECTION("- Exceptions") {
+    REQUIRE(round_trip("") == "");
+    REQUIRE(round_trip("N") == "N");
+    REQUIRE(round_trip("ACGTN") == "ACGTN");
+    REQUIRE(round_trip("NNNNNNNN") == "NNNNNNNN");
+    REQUIRE(round_trip("acgtRYKMSWBDHVN.-") == "acgtRYKMSWBDHVN.-");
+    std::string long_gap(1000, 'A');
+    long_gap[0] = long_gap[999] = 'N';
+    long_gap[500] = 'n';
+    REQUIRE(round_trip(long_gap) == long_gap);
+  }
+
+  SECTION("- Random sequences") {
+    // Lengths around multiples of 64 exercise the vectorized unpacking.
+    std::mt19937 gen(0);
+    const std::string symbols = "ACGTACGTACGTACGTN";
+    for (size_t len = 0; len < 300; len++) {
+      std::string bases(len, 'A');
+      for (auto& c : bases)
+        c = symbols[gen() % symbols.size()];
+      REQUIRE(round_trip(bases) == bases);
+    }
+  }
+
+  SECTION("- Malformed cells") {
+    std::vector<uint8_t> cell(sequence_codec::max_encoded_size(8));
+    const size_t cell_size = sequence_codec::encode("ACGTACGN", 8, cell.data());
+    std::string result(8, '\0');
+    REQUIRE_THROWS_AS(
+        sequence_codec::decode(cell.data(), 1, 8, &result[0]),
+        std::runtime_error);
+    REQUIRE_THROWS_AS(
+        sequence_codec::decode(cell.data(), cell_size - 1, 8, &result[0]),
+        std::runtime_error);
+    REQUIRE_THROWS_AS(
+        sequence_codec::decode(cell.data(), cell_size, 7, &result[0]),
+        std::runtime_error);
+  }
+}
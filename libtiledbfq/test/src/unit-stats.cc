@@ -0,0 +1,111 @@
+/**
+ * @file   unit-stats.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2019 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for Stats.
+ */
+
+#include "catch.hpp"
+
+#include "utils/bounded_queue.h"
+#include "utils/stats.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace tiledb::fq;
+
+TEST_CASE("TileDB-FastQ: Test stats", "[tiledbfq][stats]") {
+  Stats stats;
+
+  // Counters and peaks are updated concurrently.
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < 4; t++) {
+    threads.emplace_back([&stats, t]() {
+      Stats::Counter& records = stats.counter("records");
+      Stats::Counter& peak = stats.peak("batch_bytes");
+      for (unsigned i = 0; i < 1000; i++) {
+        records++;
+        Stats::update_peak(&peak, t * 1000 + i);
+      }
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+  REQUIRE(stats.counter("records") == 4000);
+  REQUIRE(stats.peak("batch_bytes") == 3999);
+
+  {
+    ScopedTimer timer(&stats.timer("parse"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(stats.timer("parse") >= 10 * 1000 * 1000);
+
+  const std::string json = stats.to_json();
+  REQUIRE(json.find("\"counters\": {\n    \"records\": 4000\n  }") !=
+          std::string::npos);
+  REQUIRE(json.find("\"batch_bytes\": 3999") != std::string::npos);
+  REQUIRE(json.find("\"parse\": 0.0") != std::string::npos);
+
+  stats.clear();
+  REQUIRE(stats.counter("records") == 0);
+  REQUIRE(stats.to_json().find("\"records\"") != std::string::npos);
+}
+
+TEST_CASE("TileDB-FastQ: Test stats progress", "[tiledbfq][stats]") {
+  Stats stats;
+  std::ostringstream os;
+  stats.counter("records") += 10;
+  stats.start_progress(&os, "records", "bytes", 10);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  stats.stop_progress();
+  REQUIRE(os.str().find("Progress: ") == 0);
+  REQUIRE(os.str().find(" 10 records") != std::string::npos);
+}
+
+TEST_CASE("TileDB-FastQ: Test queue wait timer", "[tiledbfq][stats]") {
+  Stats stats;
+  BoundedQueue<int> queue(1);
+  queue.set_pop_wait_timer(&stats.timer("wait"));
+
+  // Pops that find a value do not wait.
+  int v;
+  REQUIRE(queue.push(1));
+  REQUIRE(queue.pop(&v));
+  REQUIRE(stats.timer("wait") == 0);
+
+  std::thread producer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.push(2);
+  });
+  REQUIRE(queue.pop(&v));
+  producer.join();
+  REQUIRE(v == 2);
+  REQUIRE(stats.timer("wait") > 0);
+}